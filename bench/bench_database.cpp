@@ -0,0 +1,592 @@
+#include <QCoreApplication>
+#include <QDate>
+#include <QFile>
+#include <QString>
+#include <QTemporaryDir>
+#include <array>
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "database.h"
+#include "models.h"
+#include "order_filter.h"
+#include "order_import.h"
+#include "order_snapshot.h"
+#include "password_hash.h"
+#include "prefix_index.h"
+
+// Runs the Database operations against throwaway SQLite files holding 10k to
+// 10M orders. Each size is seeded once per process and shared by every
+// benchmark that uses it. Results go to bench_database.json unless
+// --benchmark_out is given.
+
+namespace {
+constexpr std::size_t kSeedBatch = 50'000;
+constexpr auto kBenchUser = "bench";
+constexpr auto kBenchPassword = "bench-password";
+
+const std::array<const char *, 8> kProducts = {
+    "Pallet", "Crate",  "Container", "Drum",
+    "Bundle", "Parcel", "Envelope",  "Tube",
+};
+
+QTemporaryDir &scratchDir() {
+  static QTemporaryDir dir;
+  return dir;
+}
+
+OrderDraft makeOrder(std::mt19937_64 &rng) {
+  std::uniform_int_distribution<int> customer(1, 50'000);
+  std::uniform_int_distribution<std::size_t> product(0, kProducts.size() - 1);
+  std::uniform_int_distribution<int> quantity(1, 500);
+  std::uniform_int_distribution<int> status(
+      0, static_cast<int>(orderStatuses().size()) - 1);
+  std::uniform_int_distribution<int> day(0, 5 * 365);
+
+  OrderDraft o;
+  o.customer = QString("Customer %1").arg(customer(rng));
+  o.product = QString::fromLatin1(kProducts[product(rng)]);
+  o.quantity = quantity(rng);
+  o.status = static_cast<OrderStatus>(status(rng));
+  o.orderDate = QDate(2020, 1, 1).addDays(day(rng));
+  return o;
+}
+
+void skipWithDbError(benchmark::State &state, const Database &db) {
+  state.SkipWithError(db.lastError().toStdString().c_str());
+}
+
+struct SeededDatabase {
+  std::unique_ptr<Database> db;
+  std::mt19937_64 rng{42};
+  long long rows = 0;
+};
+
+std::map<long long, SeededDatabase> &seededDatabases() {
+  static std::map<long long, SeededDatabase> databases;
+  return databases;
+}
+
+// Opened, migrated database with `rows` orders and one user; null (with
+// the benchmark marked as errored) on failure.
+SeededDatabase *seeded(benchmark::State &state, long long rows) {
+  auto &databases = seededDatabases();
+  if (auto it = databases.find(rows); it != databases.end()) {
+    return &it->second;
+  }
+
+  const auto name = QString("bench_%1").arg(rows);
+  SeededDatabase s;
+  s.db = std::make_unique<Database>(
+      name, scratchDir().filePath(name + ".sqlite"));
+  auto &db = *s.db;
+  if (!db.open() || !db.migrate()) {
+    skipWithDbError(state, db);
+    return nullptr;
+  }
+
+  {
+    ScopedProfile ingest(db, ConnectionProfile::BulkIngest);
+    std::vector<OrderDraft> batch;
+    batch.reserve(kSeedBatch);
+    for (long long done = 0; done < rows;) {
+      batch.clear();
+      for (; batch.size() < kSeedBatch && done < rows; ++done) {
+        batch.push_back(makeOrder(s.rng));
+      }
+      if (!db.insertOrders(batch)) {
+        skipWithDbError(state, db);
+        return nullptr;
+      }
+    }
+  }
+  if (!db.createUser(kBenchUser, kBenchPassword, "admin")) {
+    skipWithDbError(state, db);
+    return nullptr;
+  }
+
+  s.rows = rows;
+  return &databases.emplace(rows, std::move(s)).first->second;
+}
+
+long long randomId(SeededDatabase &s) {
+  return std::uniform_int_distribution<long long>(1, s.rows)(s.rng);
+}
+
+// Inputs for the single-row benchmarks, made before timing starts: pausing
+// the timer every iteration costs more than the statements being timed.
+constexpr std::size_t kInputs = 1024;
+
+std::vector<OrderDraft> makeOrders(SeededDatabase &s) {
+  std::vector<OrderDraft> orders;
+  orders.reserve(kInputs);
+  for (std::size_t i = 0; i < kInputs; ++i) {
+    orders.push_back(makeOrder(s.rng));
+  }
+  return orders;
+}
+
+std::vector<long long> randomIds(SeededDatabase &s) {
+  std::vector<long long> ids;
+  ids.reserve(kInputs);
+  for (std::size_t i = 0; i < kInputs; ++i) {
+    ids.push_back(randomId(s));
+  }
+  return ids;
+}
+
+void BM_InsertOrder(benchmark::State &state) {
+  auto *s = seeded(state, state.range(0));
+  if (!s) {
+    return;
+  }
+  const auto orders = makeOrders(*s);
+  std::size_t next = 0;
+  for (auto _ : state) {
+    if (!s->db->insertOrder(orders[next++ % orders.size()])) {
+      skipWithDbError(state, *s->db);
+      break;
+    }
+  }
+}
+
+void BM_GetOrder(benchmark::State &state) {
+  auto *s = seeded(state, state.range(0));
+  if (!s) {
+    return;
+  }
+  const auto ids = randomIds(*s);
+  std::size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(s->db->getOrder(ids[next++ % ids.size()]));
+  }
+}
+
+void BM_UpdateOrder(benchmark::State &state) {
+  auto *s = seeded(state, state.range(0));
+  if (!s) {
+    return;
+  }
+  const auto ids = randomIds(*s);
+  const auto orders = makeOrders(*s);
+  std::size_t next = 0;
+  for (auto _ : state) {
+    const auto i = next++ % kInputs;
+    if (!s->db->updateOrder(ids[i], orders[i])) {
+      skipWithDbError(state, *s->db);
+      break;
+    }
+  }
+}
+
+// Sets the status of 5,000 random orders in one bulk update, as when a
+// shift's orders are marked shipped together.
+void BM_UpdateOrdersStatus(benchmark::State &state) {
+  auto *s = seeded(state, state.range(0));
+  if (!s) {
+    return;
+  }
+  constexpr std::size_t kBulkOrders = 5'000;
+  OrderEdit edit;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<long long> ids;
+    ids.reserve(kBulkOrders);
+    for (std::size_t i = 0; i < kBulkOrders; ++i) {
+      ids.push_back(randomId(*s));
+    }
+    edit.status = static_cast<OrderStatus>(
+        randomId(*s) % static_cast<long long>(orderStatuses().size()));
+    state.ResumeTiming();
+    if (!s->db->updateOrders(OrderSet::withIds(std::move(ids)), edit)) {
+      skipWithDbError(state, *s->db);
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<long long>(kBulkOrders));
+}
+
+// Deletes orders inserted (untimed) by the benchmark itself, so the seeded
+// rows stay in place for the other benchmarks. They are inserted kInputs
+// at a time, so the timer pauses once per batch rather than per delete.
+void BM_DeleteOrder(benchmark::State &state) {
+  auto *s = seeded(state, state.range(0));
+  if (!s) {
+    return;
+  }
+  const auto orders = makeOrders(*s);
+  std::vector<long long> ids;
+  ids.reserve(kInputs);
+  for (auto _ : state) {
+    if (ids.empty()) {
+      state.PauseTiming();
+      for (const auto &order : orders) {
+        const auto id = s->db->insertOrder(order);
+        if (!id) {
+          break;
+        }
+        ids.push_back(*id);
+      }
+      state.ResumeTiming();
+      if (ids.size() != orders.size()) {
+        skipWithDbError(state, *s->db);
+        break;
+      }
+    }
+    if (!s->db->deleteOrder(ids.back())) {
+      skipWithDbError(state, *s->db);
+      break;
+    }
+    ids.pop_back();
+  }
+  // Leave the seeded table as it was for the benchmarks that follow.
+  for (const auto id : ids) {
+    s->db->deleteOrder(id);
+  }
+}
+
+// Scrolls through the first 10,000 rows the way the orders list does: one
+// keyset page of 256 at a time. Reading every row of the larger databases
+// would measure allocating millions of OrderRows instead.
+void BM_ListOrders(benchmark::State &state) {
+  auto *s = seeded(state, state.range(0));
+  if (!s) {
+    return;
+  }
+  constexpr int kPage = 256;
+  constexpr long long kRows = 10'000;
+  const OrderQuery query;
+  long long read = 0;
+  for (auto _ : state) {
+    std::optional<OrderCursor> after;
+    for (long long done = 0; done < kRows;) {
+      const auto page = s->db->listOrdersPage(query, after, 0, kPage);
+      if (page.empty()) {
+        if (!s->db->lastError().isEmpty()) {
+          skipWithDbError(state, *s->db);
+        }
+        break;
+      }
+      done += static_cast<long long>(page.size());
+      read += static_cast<long long>(page.size());
+      after = OrderCursor{{}, page.back().id};
+    }
+    benchmark::DoNotOptimize(after);
+  }
+  state.SetItemsProcessed(read);
+}
+
+void BM_VerifyUser(benchmark::State &state) {
+  auto *s = seeded(state, state.range(0));
+  if (!s) {
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(s->db->verifyUser(kBenchUser, kBenchPassword));
+  }
+}
+
+// Picks the PBKDF2 cost for a sign-in budget of arg 0 milliseconds, then
+// times a verification at that cost. Pass the "cost" counter to the app's
+// --password-cost option.
+void BM_PasswordCost(benchmark::State &state) {
+  const auto cost =
+      calibratePasswordCost(std::chrono::milliseconds(state.range(0)));
+  const auto hash = hashPassword(kBenchPassword, cost);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(verifyPassword(kBenchPassword, hash));
+  }
+  state.counters["cost"] = cost;
+}
+
+// What the orders screen runs for a search: the row count, then the first
+// page. Arg 1 picks the search box and status combo values.
+void BM_HomeScreenFilter(benchmark::State &state) {
+  struct Search {
+    const char *label;
+    const char *term;
+    std::optional<OrderStatus> status;
+  };
+  static const std::array<Search, 4> kSearches = {{
+      {"customer", "Customer 123", std::nullopt},
+      {"prefix", "cont", std::nullopt},
+      {"status-term", "ship", std::nullopt},
+      {"term+status", "pallet", OrderStatus::Pending},
+  }};
+
+  auto *s = seeded(state, state.range(0));
+  if (!s) {
+    return;
+  }
+  const auto &search = kSearches.at(state.range(1));
+  state.SetLabel(search.label);
+
+  OrderQuery query;
+  query.filter = orderSearchFilter(search.term, search.status);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(s->db->countOrders(query));
+    const auto page = s->db->listOrdersPage(query, std::nullopt, 0, 256);
+    benchmark::DoNotOptimize(page.data());
+  }
+}
+
+std::map<long long, OrderSnapshot> &snapshots() {
+  static std::map<long long, OrderSnapshot> loaded;
+  return loaded;
+}
+
+const OrderSnapshot *snapshot(benchmark::State &state, long long rows) {
+  auto &loaded = snapshots();
+  if (auto it = loaded.find(rows); it != loaded.end()) {
+    return &it->second;
+  }
+  auto *s = seeded(state, rows);
+  if (!s) {
+    return nullptr;
+  }
+  auto snap = OrderSnapshot::load(*s->db);
+  if (!snap) {
+    skipWithDbError(state, *s->db);
+    return nullptr;
+  }
+  return &loaded.emplace(rows, std::move(*snap)).first->second;
+}
+
+// In-memory analytics over a one-year window. Arg 1 is the worker count,
+// so the rows/s counter shows how the kernels scale with cores.
+void BM_SnapshotQuantityByStatus(benchmark::State &state) {
+  const auto *snap = snapshot(state, state.range(0));
+  if (!snap) {
+    return;
+  }
+  const auto threads = static_cast<int>(state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(snap->quantityByStatus(
+        QDate(2021, 1, 1), QDate(2022, 1, 1), threads));
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<long long>(snap->size()));
+}
+
+void BM_SnapshotTopProducts(benchmark::State &state) {
+  const auto *snap = snapshot(state, state.range(0));
+  if (!snap) {
+    return;
+  }
+  const auto threads = static_cast<int>(state.range(1));
+  for (auto _ : state) {
+    const auto top = snap->topProducts(QDate(2021, 1, 1), QDate(2021, 2, 1),
+                                       5, threads);
+    benchmark::DoNotOptimize(top.data());
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<long long>(snap->size()));
+}
+
+// Type-ahead over N distinct Zipf-weighted names. Each iteration asks for
+// the top 8 under one of a fixed set of one- to three-letter prefixes.
+void BM_PrefixIndexTopMatches(benchmark::State &state) {
+  const auto distinct = static_cast<std::size_t>(state.range(0));
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::vector<ValueFrequency> values;
+  values.reserve(distinct);
+  for (std::size_t i = 0; i < distinct; ++i) {
+    QString name;
+    for (int c = 0; c < 10; ++c) {
+      name += QChar(letter(rng));
+    }
+    values.push_back({name, static_cast<long long>(1'000'000 / (i + 1))});
+  }
+  const PrefixIndex index(values);
+
+  std::vector<QString> prefixes;
+  for (int len = 1; len <= 3; ++len) {
+    for (int i = 0; i < 16; ++i) {
+      QString p;
+      for (int c = 0; c < len; ++c) {
+        p += QChar(letter(rng));
+      }
+      prefixes.push_back(p);
+    }
+  }
+
+  std::size_t next = 0;
+  for (auto _ : state) {
+    const auto matches =
+        index.topMatches(prefixes[next++ % prefixes.size()], 8);
+    benchmark::DoNotOptimize(matches.size());
+  }
+}
+
+// CSV file of `rows` random orders, written once per process.
+QString importFile(long long rows) {
+  static std::map<long long, QString> files;
+  if (auto it = files.find(rows); it != files.end()) {
+    return it->second;
+  }
+  const auto path = scratchDir().filePath(QString("import_%1.csv").arg(rows));
+  std::ofstream out(std::filesystem::path(path.toStdU16String()),
+                    std::ios::binary);
+  out << "customer,product,quantity,status,order_date\n";
+  std::mt19937_64 rng(7);
+  for (long long i = 0; i < rows; ++i) {
+    const auto o = makeOrder(rng);
+    out << o.customer.toStdString() << ',' << o.product.toStdString() << ','
+        << o.quantity << ',' << orderStatusName(o.status).toStdString()
+        << ',' << o.orderDate.toString(Qt::ISODate).toStdString() << '\n';
+  }
+  return files.emplace(rows, path).first->second;
+}
+
+// Imports a CSV file of arg 0 orders into an empty database, batch by
+// batch under the bulk-ingest profile, as the Import Orders button does.
+void BM_ImportOrders(benchmark::State &state) {
+  const auto rows = state.range(0);
+  const auto file = importFile(rows);
+  long long run = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    const auto name = QString("bench_import_%1").arg(++run);
+    const auto path = scratchDir().filePath(name + ".sqlite");
+    {
+      Database db(name, path);
+      if (!db.open() || !db.migrate()) {
+        skipWithDbError(state, db);
+        break;
+      }
+      state.ResumeTiming();
+      const auto report = importOrders(db, file, ImportFormat::Csv);
+      state.PauseTiming();
+      if (!report.error.isEmpty()) {
+        state.SkipWithError(report.error.toStdString().c_str());
+        break;
+      }
+      db.close();
+    }
+    QFile::remove(path);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * rows);
+}
+
+void BM_MigrateFromScratch(benchmark::State &state) {
+  long long run = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    const auto name = QString("bench_migrate_%1").arg(++run);
+    const auto path = scratchDir().filePath(name + ".sqlite");
+    state.ResumeTiming();
+    {
+      Database db(name, path);
+      if (!db.open() || !db.migrate()) {
+        skipWithDbError(state, db);
+        break;
+      }
+      db.close();
+    }
+    state.PauseTiming();
+    QFile::remove(path);
+    state.ResumeTiming();
+  }
+}
+
+void orderSizes(benchmark::internal::Benchmark *b) {
+  for (long long rows : {10'000LL, 100'000LL, 1'000'000LL, 10'000'000LL}) {
+    b->Arg(rows);
+  }
+}
+
+void filterArgs(benchmark::internal::Benchmark *b) {
+  for (long long rows : {10'000LL, 100'000LL, 1'000'000LL, 10'000'000LL}) {
+    for (long long search = 0; search < 4; ++search) {
+      b->Args({rows, search});
+    }
+  }
+}
+
+void snapshotArgs(benchmark::internal::Benchmark *b) {
+  for (long long rows : {1'000'000LL, 10'000'000LL}) {
+    for (long long threads : {1LL, 2LL, 4LL, 8LL, 16LL}) {
+      b->Args({rows, threads});
+    }
+  }
+}
+} // namespace
+
+BENCHMARK(BM_InsertOrder)->Apply(orderSizes);
+BENCHMARK(BM_GetOrder)->Apply(orderSizes);
+BENCHMARK(BM_UpdateOrder)->Apply(orderSizes);
+BENCHMARK(BM_DeleteOrder)->Apply(orderSizes);
+BENCHMARK(BM_UpdateOrdersStatus)
+    ->Apply(orderSizes)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ListOrders)->Apply(orderSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VerifyUser)->Apply(orderSizes);
+BENCHMARK(BM_PasswordCost)
+    ->Arg(100)
+    ->Arg(250)
+    ->Arg(500)
+    ->Iterations(5)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HomeScreenFilter)
+    ->Apply(filterArgs)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SnapshotQuantityByStatus)
+    ->Apply(snapshotArgs)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SnapshotTopProducts)
+    ->Apply(snapshotArgs)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PrefixIndexTopMatches)
+    ->Arg(100'000)
+    ->Arg(500'000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ImportOrders)
+    ->Arg(100'000)
+    ->Arg(1'000'000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MigrateFromScratch)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+
+  std::vector<std::string> args(argv, argv + argc);
+  bool hasOut = false;
+  for (const auto &a : args) {
+    hasOut = hasOut || a.starts_with("--benchmark_out=");
+  }
+  if (!hasOut) {
+    args.push_back("--benchmark_out=bench_database.json");
+    args.push_back("--benchmark_out_format=json");
+  }
+  std::vector<char *> benchArgv;
+  for (auto &a : args) {
+    benchArgv.push_back(a.data());
+  }
+  int benchArgc = static_cast<int>(benchArgv.size());
+
+  benchmark::Initialize(&benchArgc, benchArgv.data());
+  if (benchmark::ReportUnrecognizedArguments(benchArgc, benchArgv.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  snapshots().clear();
+  for (auto &[rows, s] : seededDatabases()) {
+    s.db->close();
+  }
+  seededDatabases().clear();
+  return 0;
+}
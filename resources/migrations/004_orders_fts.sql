@@ -0,0 +1,22 @@
+CREATE VIRTUAL TABLE IF NOT EXISTS orders_fts USING fts5(
+  customer,
+  product,
+  content='orders',
+  content_rowid='id',
+  prefix='2 3'
+);
+INSERT INTO orders_fts(orders_fts) VALUES('rebuild');
+CREATE TRIGGER IF NOT EXISTS orders_fts_ai AFTER INSERT ON orders BEGIN
+  INSERT INTO orders_fts(rowid, customer, product)
+  VALUES (new.id, new.customer, new.product);
+END;
+CREATE TRIGGER IF NOT EXISTS orders_fts_ad AFTER DELETE ON orders BEGIN
+  INSERT INTO orders_fts(orders_fts, rowid, customer, product)
+  VALUES ('delete', old.id, old.customer, old.product);
+END;
+CREATE TRIGGER IF NOT EXISTS orders_fts_au AFTER UPDATE OF customer, product ON orders BEGIN
+  INSERT INTO orders_fts(orders_fts, rowid, customer, product)
+  VALUES ('delete', old.id, old.customer, old.product);
+  INSERT INTO orders_fts(rowid, customer, product)
+  VALUES (new.id, new.customer, new.product);
+END;
@@ -0,0 +1,61 @@
+CREATE TABLE IF NOT EXISTS statuses(
+  id INTEGER PRIMARY KEY,
+  name TEXT NOT NULL UNIQUE
+);
+INSERT INTO statuses(id, name) VALUES
+  (0, 'pending'),
+  (1, 'processing'),
+  (2, 'shipped'),
+  (3, 'delivered'),
+  (4, 'cancelled');
+CREATE TEMP TABLE status_migration_check(unmapped INTEGER NOT NULL);
+CREATE TEMP TRIGGER status_migration_guard
+BEFORE INSERT ON status_migration_check
+WHEN new.unmapped > 0 BEGIN
+  SELECT RAISE(ABORT, 'orders.status holds values that are not a known status');
+END;
+INSERT INTO status_migration_check(unmapped)
+SELECT COUNT(*)
+FROM orders o
+LEFT JOIN statuses s ON s.name = lower(trim(o.status))
+WHERE s.id IS NULL;
+DROP TABLE status_migration_check;
+CREATE TABLE orders_new(
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  customer TEXT NOT NULL,
+  product TEXT NOT NULL,
+  quantity INTEGER NOT NULL,
+  status INTEGER NOT NULL REFERENCES statuses(id),
+  order_date TEXT NOT NULL
+);
+INSERT INTO orders_new(id, customer, product, quantity, status, order_date)
+SELECT o.id, o.customer, o.product, o.quantity, s.id, o.order_date
+FROM orders o
+JOIN statuses s ON s.name = lower(trim(o.status));
+DELETE FROM sqlite_sequence WHERE name = 'orders_new';
+INSERT INTO sqlite_sequence(name, seq)
+SELECT 'orders_new', seq FROM sqlite_sequence WHERE name = 'orders';
+DROP TABLE orders;
+ALTER TABLE orders_new RENAME TO orders;
+CREATE INDEX IF NOT EXISTS idx_orders_status
+ON orders(status);
+CREATE INDEX IF NOT EXISTS idx_orders_order_date
+ON orders(order_date);
+CREATE INDEX IF NOT EXISTS idx_orders_customer
+ON orders(customer);
+CREATE INDEX IF NOT EXISTS idx_orders_product
+ON orders(product);
+CREATE TRIGGER IF NOT EXISTS orders_fts_ai AFTER INSERT ON orders BEGIN
+  INSERT INTO orders_fts(rowid, customer, product)
+  VALUES (new.id, new.customer, new.product);
+END;
+CREATE TRIGGER IF NOT EXISTS orders_fts_ad AFTER DELETE ON orders BEGIN
+  INSERT INTO orders_fts(orders_fts, rowid, customer, product)
+  VALUES ('delete', old.id, old.customer, old.product);
+END;
+CREATE TRIGGER IF NOT EXISTS orders_fts_au AFTER UPDATE OF customer, product ON orders BEGIN
+  INSERT INTO orders_fts(orders_fts, rowid, customer, product)
+  VALUES ('delete', old.id, old.customer, old.product);
+  INSERT INTO orders_fts(rowid, customer, product)
+  VALUES (new.id, new.customer, new.product);
+END;
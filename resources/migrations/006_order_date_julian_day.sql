@@ -0,0 +1,39 @@
+CREATE TABLE orders_new(
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  customer TEXT NOT NULL,
+  product TEXT NOT NULL,
+  quantity INTEGER NOT NULL,
+  status INTEGER NOT NULL REFERENCES statuses(id),
+  order_date INTEGER NOT NULL
+);
+INSERT INTO orders_new(id, customer, product, quantity, status, order_date)
+SELECT id, customer, product, quantity, status,
+       CAST(julianday(order_date) + 0.5 AS INTEGER)
+FROM orders;
+DELETE FROM sqlite_sequence WHERE name = 'orders_new';
+INSERT INTO sqlite_sequence(name, seq)
+SELECT 'orders_new', seq FROM sqlite_sequence WHERE name = 'orders';
+DROP TABLE orders;
+ALTER TABLE orders_new RENAME TO orders;
+CREATE INDEX IF NOT EXISTS idx_orders_status
+ON orders(status);
+CREATE INDEX IF NOT EXISTS idx_orders_order_date
+ON orders(order_date);
+CREATE INDEX IF NOT EXISTS idx_orders_customer
+ON orders(customer);
+CREATE INDEX IF NOT EXISTS idx_orders_product
+ON orders(product);
+CREATE TRIGGER IF NOT EXISTS orders_fts_ai AFTER INSERT ON orders BEGIN
+  INSERT INTO orders_fts(rowid, customer, product)
+  VALUES (new.id, new.customer, new.product);
+END;
+CREATE TRIGGER IF NOT EXISTS orders_fts_ad AFTER DELETE ON orders BEGIN
+  INSERT INTO orders_fts(orders_fts, rowid, customer, product)
+  VALUES ('delete', old.id, old.customer, old.product);
+END;
+CREATE TRIGGER IF NOT EXISTS orders_fts_au AFTER UPDATE OF customer, product ON orders BEGIN
+  INSERT INTO orders_fts(orders_fts, rowid, customer, product)
+  VALUES ('delete', old.id, old.customer, old.product);
+  INSERT INTO orders_fts(rowid, customer, product)
+  VALUES (new.id, new.customer, new.product);
+END;
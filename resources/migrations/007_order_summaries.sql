@@ -0,0 +1,77 @@
+CREATE TABLE IF NOT EXISTS order_status_counts(
+  status INTEGER PRIMARY KEY REFERENCES statuses(id),
+  orders INTEGER NOT NULL DEFAULT 0
+);
+CREATE TABLE IF NOT EXISTS product_daily_totals(
+  product TEXT NOT NULL,
+  order_date INTEGER NOT NULL,
+  orders INTEGER NOT NULL,
+  quantity INTEGER NOT NULL,
+  PRIMARY KEY (product, order_date)
+) WITHOUT ROWID;
+CREATE INDEX IF NOT EXISTS idx_product_daily_totals_day
+ON product_daily_totals(order_date, quantity);
+CREATE TABLE IF NOT EXISTS customer_order_counts(
+  customer TEXT PRIMARY KEY,
+  orders INTEGER NOT NULL
+) WITHOUT ROWID;
+CREATE INDEX IF NOT EXISTS idx_customer_order_counts_orders
+ON customer_order_counts(orders);
+INSERT INTO order_status_counts(status, orders)
+SELECT s.id, (SELECT COUNT(*) FROM orders o WHERE o.status = s.id)
+FROM statuses s;
+INSERT INTO product_daily_totals(product, order_date, orders, quantity)
+SELECT product, order_date, COUNT(*), SUM(quantity)
+FROM orders
+GROUP BY product, order_date;
+INSERT INTO customer_order_counts(customer, orders)
+SELECT customer, COUNT(*)
+FROM orders
+GROUP BY customer;
+CREATE TRIGGER IF NOT EXISTS orders_summary_ai AFTER INSERT ON orders BEGIN
+  UPDATE order_status_counts SET orders = orders + 1
+  WHERE status = new.status;
+  INSERT INTO product_daily_totals(product, order_date, orders, quantity)
+  VALUES (new.product, new.order_date, 1, new.quantity)
+  ON CONFLICT(product, order_date) DO UPDATE
+  SET orders = orders + 1, quantity = quantity + excluded.quantity;
+  INSERT INTO customer_order_counts(customer, orders)
+  VALUES (new.customer, 1)
+  ON CONFLICT(customer) DO UPDATE SET orders = orders + 1;
+END;
+CREATE TRIGGER IF NOT EXISTS orders_summary_ad AFTER DELETE ON orders BEGIN
+  UPDATE order_status_counts SET orders = orders - 1
+  WHERE status = old.status;
+  UPDATE product_daily_totals
+  SET orders = orders - 1, quantity = quantity - old.quantity
+  WHERE product = old.product AND order_date = old.order_date;
+  DELETE FROM product_daily_totals
+  WHERE product = old.product AND order_date = old.order_date AND orders = 0;
+  UPDATE customer_order_counts SET orders = orders - 1
+  WHERE customer = old.customer;
+  DELETE FROM customer_order_counts
+  WHERE customer = old.customer AND orders = 0;
+END;
+CREATE TRIGGER IF NOT EXISTS orders_summary_au
+AFTER UPDATE OF customer, product, quantity, status, order_date ON orders BEGIN
+  UPDATE order_status_counts SET orders = orders - 1
+  WHERE status = old.status;
+  UPDATE order_status_counts SET orders = orders + 1
+  WHERE status = new.status;
+  UPDATE product_daily_totals
+  SET orders = orders - 1, quantity = quantity - old.quantity
+  WHERE product = old.product AND order_date = old.order_date;
+  DELETE FROM product_daily_totals
+  WHERE product = old.product AND order_date = old.order_date AND orders = 0;
+  INSERT INTO product_daily_totals(product, order_date, orders, quantity)
+  VALUES (new.product, new.order_date, 1, new.quantity)
+  ON CONFLICT(product, order_date) DO UPDATE
+  SET orders = orders + 1, quantity = quantity + excluded.quantity;
+  UPDATE customer_order_counts SET orders = orders - 1
+  WHERE customer = old.customer;
+  DELETE FROM customer_order_counts
+  WHERE customer = old.customer AND orders = 0;
+  INSERT INTO customer_order_counts(customer, orders)
+  VALUES (new.customer, 1)
+  ON CONFLICT(customer) DO UPDATE SET orders = orders + 1;
+END;
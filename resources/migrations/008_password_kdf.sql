@@ -0,0 +1,2 @@
+ALTER TABLE users ADD COLUMN password_algo TEXT NOT NULL DEFAULT 'sha256';
+ALTER TABLE users ADD COLUMN password_cost INTEGER NOT NULL DEFAULT 1;
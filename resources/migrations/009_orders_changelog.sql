@@ -0,0 +1,14 @@
+CREATE TABLE IF NOT EXISTS orders_changelog(
+  seq INTEGER PRIMARY KEY AUTOINCREMENT,
+  order_id INTEGER NOT NULL,
+  kind INTEGER NOT NULL
+);
+CREATE TRIGGER IF NOT EXISTS orders_changelog_ai AFTER INSERT ON orders BEGIN
+  INSERT INTO orders_changelog(order_id, kind) VALUES (new.id, 0);
+END;
+CREATE TRIGGER IF NOT EXISTS orders_changelog_au AFTER UPDATE ON orders BEGIN
+  INSERT INTO orders_changelog(order_id, kind) VALUES (new.id, 1);
+END;
+CREATE TRIGGER IF NOT EXISTS orders_changelog_ad AFTER DELETE ON orders BEGIN
+  INSERT INTO orders_changelog(order_id, kind) VALUES (old.id, 2);
+END;
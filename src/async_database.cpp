@@ -0,0 +1,150 @@
+#include "async_database.h"
+#include "password_hash.h"
+
+#include <QDebug>
+
+namespace {
+// What the database thread hands to the derivation: the stored hash, or a
+// dummy one when the username does not exist.
+struct StoredCredentials {
+  std::optional<UserRow> user;
+  PasswordHash hash;
+  int cost = kDefaultPasswordCost;
+};
+
+struct SignInCheck {
+  std::optional<UserRow> user;
+  std::optional<PasswordHash> rehash; // to store, when the cost changed
+  QString error;
+};
+} // namespace
+
+AsyncDatabase::AsyncDatabase(const QString &connectionName, QObject *parent)
+    : QObject(parent), worker(new QObject), db(connectionName) {
+  thread.setObjectName(connectionName);
+  worker->moveToThread(&thread);
+  thread.start();
+}
+
+AsyncDatabase::~AsyncDatabase() {
+  // The connection belongs to the worker thread and has to be closed there.
+  QMetaObject::invokeMethod(worker, [this] { db.close(); },
+                            Qt::BlockingQueuedConnection);
+  thread.quit();
+  thread.wait();
+  delete worker;
+}
+
+QFuture<DbResult<bool>> AsyncDatabase::open(ConnectionProfile profile) {
+  return run([profile](Database &d) { return d.open(profile); });
+}
+
+QFuture<DbResult<std::optional<long long>>>
+AsyncDatabase::insertOrder(const OrderDraft &order) {
+  return run([order](Database &d) { return d.insertOrder(order); });
+}
+
+QFuture<DbResult<std::optional<OrderRow>>>
+AsyncDatabase::getOrder(long long orderId) {
+  return run([orderId](Database &d) { return d.getOrder(orderId); });
+}
+
+QFuture<DbResult<bool>> AsyncDatabase::updateOrder(long long orderId,
+                                                   const OrderDraft &order) {
+  return run(
+      [orderId, order](Database &d) { return d.updateOrder(orderId, order); });
+}
+
+QFuture<DbResult<bool>> AsyncDatabase::deleteOrder(long long orderId) {
+  return run([orderId](Database &d) { return d.deleteOrder(orderId); });
+}
+
+QFuture<DbResult<std::optional<long long>>>
+AsyncDatabase::updateOrders(const OrderSet &orders, const OrderEdit &edit) {
+  return run(
+      [orders, edit](Database &d) { return d.updateOrders(orders, edit); });
+}
+
+QFuture<DbResult<std::optional<long long>>>
+AsyncDatabase::deleteOrders(const OrderSet &orders) {
+  return run([orders](Database &d) { return d.deleteOrders(orders); });
+}
+
+QFuture<DbResult<std::optional<long long>>>
+AsyncDatabase::countOrders(const OrderQuery &query) {
+  return run([query](Database &d) { return d.countOrders(query); });
+}
+
+QFuture<DbResult<std::vector<OrderRow>>>
+AsyncDatabase::listOrdersPage(const OrderQuery &query,
+                              const std::optional<OrderCursor> &after,
+                              long long skip, int limit) {
+  return run([query, after, skip, limit](Database &d) {
+    return d.listOrdersPage(query, after, skip, limit);
+  });
+}
+
+QFuture<DbResult<bool>> AsyncDatabase::hasAnyUsers() {
+  return run([](Database &d) { return d.hasAnyUsers(); });
+}
+
+QFuture<DbResult<std::optional<UserRow>>>
+AsyncDatabase::createUser(const QString &username, const QString &password,
+                          const QString &role) {
+  return run([username, password, role](Database &d) {
+    return d.createUser(username, password, role);
+  });
+}
+
+QFuture<DbResult<std::optional<UserRow>>>
+AsyncDatabase::verifyUser(const QString &username, const QString &password) {
+  // Only the lookup and the hash upgrade run here; the key derivation runs
+  // on the thread pool so calls queued behind a sign-in are not held up.
+  return run([username](Database &d) {
+           StoredCredentials c;
+           c.cost = d.currentPasswordCost();
+           UserRow user;
+           if (d.loadCredentials(username, user, c.hash)) {
+             c.user = user;
+           } else {
+             // An unknown username costs a derivation too, so the response
+             // time does not reveal which usernames exist.
+             c.hash = dummyPasswordHash(c.cost);
+           }
+           return c;
+         })
+      .then(QtFuture::Launch::Async,
+            [password](DbResult<StoredCredentials> r) {
+              SignInCheck check;
+              check.error = r.error;
+              if (!r.error.isEmpty() ||
+                  !verifyPassword(password, r.value.hash) || !r.value.user) {
+                return check;
+              }
+              check.user = r.value.user;
+              if (needsRehash(r.value.hash, r.value.cost)) {
+                check.rehash = hashPassword(password, r.value.cost);
+              }
+              return check;
+            })
+      .then(this, [this](const SignInCheck &check) {
+        if (check.rehash) {
+          run([user = *check.user, hash = *check.rehash](Database &d) {
+            if (!d.storePasswordHash(user.id, hash)) {
+              // The old hash still works; try again on the next sign-in.
+              qWarning().noquote() << "Failed to upgrade password hash for"
+                                   << user.username << ":" << d.lastError();
+            }
+            return true;
+          });
+        }
+        return DbResult<std::optional<UserRow>>{check.user, check.error};
+      });
+}
+
+void AsyncDatabase::setPasswordCost(int cost) {
+  run([cost](Database &d) {
+    d.setPasswordCost(cost);
+    return true;
+  });
+}
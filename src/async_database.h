@@ -0,0 +1,113 @@
+#pragma once
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "database.h"
+#include "models.h"
+
+// Value returned by a call on the database thread, plus the error text
+// Database reported for it (empty on success).
+template <typename T> struct DbResult {
+  T value{};
+  QString error;
+};
+
+// Database on its own connection and worker thread. Calls are posted to the
+// worker's event queue and run there one at a time, in submission order.
+// Results come back through QFuture; attach continuations with
+// .then(context, ...) to handle them on the context object's thread.
+class AsyncDatabase final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit AsyncDatabase(const QString &connectionName,
+                         QObject *parent = nullptr);
+  ~AsyncDatabase() override;
+
+  QFuture<DbResult<bool>>
+  open(ConnectionProfile profile = ConnectionProfile::Interactive);
+  // Aborts the statement the worker is running right now, if any; queued
+  // calls are not affected. Called from the owner's thread.
+  void interrupt() { db.interrupt(); }
+  // Calls submitted and not yet finished, including the running one.
+  int pendingCalls() const { return pending.load(); }
+
+  // order
+  QFuture<DbResult<std::optional<long long>>>
+  insertOrder(const OrderDraft &order);
+  QFuture<DbResult<std::optional<OrderRow>>> getOrder(long long orderId);
+  QFuture<DbResult<bool>> updateOrder(long long orderId,
+                                      const OrderDraft &order);
+  QFuture<DbResult<bool>> deleteOrder(long long orderId);
+  QFuture<DbResult<std::optional<long long>>>
+  updateOrders(const OrderSet &orders, const OrderEdit &edit);
+  QFuture<DbResult<std::optional<long long>>>
+  deleteOrders(const OrderSet &orders);
+  QFuture<DbResult<std::optional<long long>>>
+  countOrders(const OrderQuery &query);
+  QFuture<DbResult<std::vector<OrderRow>>>
+  listOrdersPage(const OrderQuery &query,
+                 const std::optional<OrderCursor> &after, long long skip,
+                 int limit);
+
+  // user: password hashing is deliberately slow, so it runs off the GUI
+  // thread; verifyUser derives on the thread pool, not on this worker.
+  QFuture<DbResult<bool>> hasAnyUsers();
+  QFuture<DbResult<std::optional<UserRow>>>
+  createUser(const QString &username, const QString &password,
+             const QString &role);
+  QFuture<DbResult<std::optional<UserRow>>>
+  verifyUser(const QString &username, const QString &password);
+  void setPasswordCost(int cost);
+
+  // Runs fn(Database &) on the worker thread.
+  template <typename F>
+  auto run(F fn) -> QFuture<DbResult<std::invoke_result_t<F, Database &>>> {
+    using T = std::invoke_result_t<F, Database &>;
+    return runTask<T>([fn = std::move(fn)](Database &d, auto &) mutable {
+      return fn(d);
+    });
+  }
+
+  // Runs fn(Database &, QPromise<DbResult<T>> &) on the worker thread. Long
+  // jobs use the promise to report progress and to notice cancellation
+  // requested through the future; a job canceled before it starts is
+  // skipped.
+  template <typename T, typename F> QFuture<DbResult<T>> runTask(F fn) {
+    auto promise = std::make_shared<QPromise<DbResult<T>>>();
+    auto future = promise->future();
+    promise->start();
+
+    ++pending;
+    QMetaObject::invokeMethod(
+        worker,
+        [this, promise, fn = std::move(fn)]() mutable {
+          if (!promise->isCanceled()) {
+            DbResult<T> r;
+            r.value = fn(db, *promise);
+            r.error = db.lastError();
+            promise->addResult(std::move(r));
+          }
+          promise->finish();
+          --pending;
+        },
+        Qt::QueuedConnection);
+
+    return future;
+  }
+
+private:
+  QThread thread;
+  QObject *worker; // lives on `thread`; posted calls run in its context
+  Database db;     // only touched from `thread`
+  std::atomic<int> pending = 0;
+};
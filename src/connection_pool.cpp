@@ -0,0 +1,44 @@
+#include "connection_pool.h"
+
+#include <QDebug>
+#include <algorithm>
+
+ConnectionPool::ConnectionPool(const QString &name, int readerCount,
+                               QObject *parent)
+    : QObject(parent), writerDb(name + "_writer") {
+  for (int i = 1; i <= readerCount; ++i) {
+    readers.push_back(std::make_unique<AsyncDatabase>(
+        QString("%1_reader_%2").arg(name).arg(i)));
+    openReaders.push_back(readers.back().get());
+  }
+}
+
+QFuture<DbResult<bool>> ConnectionPool::open(ConnectionProfile profile) {
+  // Reads queued before a reader has opened wait behind its open() on the
+  // same thread, so readers are usable right away.
+  for (const auto &owned : readers) {
+    auto *r = owned.get();
+    r->open(ConnectionProfile::ReadOnlyReporting)
+        .then(this, [this, r](DbResult<bool> opened) {
+          if (opened.value) {
+            return;
+          }
+          qWarning().noquote() << "Reader connection failed to open:"
+                               << opened.error;
+          std::erase(openReaders, r);
+        });
+  }
+  return writerDb.open(profile);
+}
+
+AsyncDatabase &ConnectionPool::reader() {
+  if (openReaders.empty()) {
+    return writerDb;
+  }
+  const auto it = std::min_element(
+      openReaders.begin(), openReaders.end(),
+      [](const AsyncDatabase *a, const AsyncDatabase *b) {
+        return a->pendingCalls() < b->pendingCalls();
+      });
+  return **it;
+}
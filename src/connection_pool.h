@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QFuture>
+#include <QObject>
+#include <QString>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "async_database.h"
+#include "database.h"
+#include "models.h"
+
+// One writer and N reader connections to the same database, each an
+// AsyncDatabase bound to its own thread. In WAL mode readers see the last
+// commit and never wait for the writer, so a long export or report does
+// not hold up interactive edits, nor the other way round.
+//
+// Writes go to writer() and run one at a time in submission order. Reads
+// go to whichever reader has the fewest calls queued; two reads may run
+// on different readers, so they are not ordered against each other.
+class ConnectionPool final : public QObject {
+public:
+  // Connections are named "<name>_writer" and "<name>_reader_<i>".
+  ConnectionPool(const QString &name, int readers, QObject *parent = nullptr);
+
+  // Opens the writer with `profile` and the readers with the read-only
+  // reporting profile. Resolves with the writer's result; a reader that
+  // fails to open is logged and taken out of rotation.
+  QFuture<DbResult<bool>>
+  open(ConnectionProfile profile = ConnectionProfile::Interactive);
+
+  AsyncDatabase &writer() { return writerDb; }
+  // The least busy open reader; the writer if none is left.
+  AsyncDatabase &reader();
+
+  // order reads
+  QFuture<DbResult<std::optional<OrderRow>>> getOrder(long long orderId) {
+    return reader().getOrder(orderId);
+  }
+  QFuture<DbResult<std::optional<long long>>>
+  countOrders(const OrderQuery &query) {
+    return reader().countOrders(query);
+  }
+  QFuture<DbResult<std::vector<OrderRow>>>
+  listOrdersPage(const OrderQuery &query,
+                 const std::optional<OrderCursor> &after, long long skip,
+                 int limit) {
+    return reader().listOrdersPage(query, after, skip, limit);
+  }
+
+  // order writes
+  QFuture<DbResult<std::optional<long long>>>
+  insertOrder(const OrderDraft &order) {
+    return writerDb.insertOrder(order);
+  }
+  QFuture<DbResult<bool>> updateOrder(long long orderId,
+                                      const OrderDraft &order) {
+    return writerDb.updateOrder(orderId, order);
+  }
+  QFuture<DbResult<bool>> deleteOrder(long long orderId) {
+    return writerDb.deleteOrder(orderId);
+  }
+  QFuture<DbResult<std::optional<long long>>>
+  updateOrders(const OrderSet &orders, const OrderEdit &edit) {
+    return writerDb.updateOrders(orders, edit);
+  }
+  QFuture<DbResult<std::optional<long long>>>
+  deleteOrders(const OrderSet &orders) {
+    return writerDb.deleteOrders(orders);
+  }
+
+  // Runs fn(Database &) on a reader, whose connection is query_only.
+  template <typename F> auto read(F fn) {
+    return reader().run(std::move(fn));
+  }
+  // Runs fn(Database &) on the writer.
+  template <typename F> auto write(F fn) {
+    return writerDb.run(std::move(fn));
+  }
+
+private:
+  AsyncDatabase writerDb;
+  std::vector<std::unique_ptr<AsyncDatabase>> readers;
+  std::vector<AsyncDatabase *> openReaders; // in rotation
+};
@@ -0,0 +1,142 @@
+#include "dashboard_screen.h"
+
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <vector>
+
+#include "models.h"
+
+namespace {
+struct DashboardData {
+  std::vector<StatusCount> statuses;
+  std::vector<ProductDayTotal> products;
+  std::vector<CustomerOrderCount> customers;
+  QString error;
+};
+
+QTableWidget *makeTable(const QStringList &headers, QWidget *parent) {
+  auto *table = new QTableWidget(0, static_cast<int>(headers.size()), parent);
+  table->setHorizontalHeaderLabels(headers);
+  table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  table->setSelectionMode(QAbstractItemView::NoSelection);
+  table->verticalHeader()->setVisible(false);
+  table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+  return table;
+}
+
+void setRow(QTableWidget *table, int row, const QStringList &cells) {
+  for (int c = 0; c < cells.size(); ++c) {
+    table->setItem(row, c, new QTableWidgetItem(cells.at(c)));
+  }
+}
+
+QGroupBox *group(const QString &title, QWidget *content, QWidget *parent) {
+  auto *box = new QGroupBox(title, parent);
+  auto *layout = new QVBoxLayout(box);
+  layout->addWidget(content);
+  return box;
+}
+} // namespace
+
+DashboardScreen::DashboardScreen(ConnectionPool *pool_, QWidget *parent)
+    : QWidget(parent), pool(pool_) {
+  auto *title = new QLabel("Dashboard", this);
+  title->setStyleSheet("font-weight: 600;");
+
+  totalValue = new QLabel("-", this);
+  errorLabel = new QLabel(this);
+  errorLabel->setStyleSheet("color: #b00020;");
+  errorLabel->setWordWrap(true);
+  errorLabel->hide();
+
+  statusTable = makeTable({"Status", "Orders"}, this);
+  productTable = makeTable({"Product", "Orders", "Quantity"}, this);
+  customerTable = makeTable({"Customer", "Orders"}, this);
+
+  dayEdit = new QDateEdit(QDate::currentDate(), this);
+  dayEdit->setCalendarPopup(true);
+
+  auto *reloadBtn = new QPushButton("Refresh", this);
+
+  auto *header = new QHBoxLayout();
+  header->addWidget(title);
+  header->addStretch(1);
+  header->addWidget(reloadBtn);
+
+  auto *totals = new QFormLayout();
+  totals->addRow("Total orders", totalValue);
+
+  auto *productBox = new QWidget(this);
+  auto *productLayout = new QVBoxLayout(productBox);
+  productLayout->setContentsMargins(0, 0, 0, 0);
+  productLayout->addWidget(dayEdit);
+  productLayout->addWidget(productTable);
+
+  auto *tables = new QHBoxLayout();
+  tables->addWidget(group("By status", statusTable, this));
+  tables->addWidget(group("Top products on day", productBox, this));
+  tables->addWidget(group("Top customers", customerTable, this));
+
+  auto *layout = new QVBoxLayout(this);
+  layout->addLayout(header);
+  layout->addLayout(totals);
+  layout->addWidget(errorLabel);
+  layout->addLayout(tables, 1);
+
+  connect(reloadBtn, &QPushButton::clicked, this, [this] { reload(); });
+  connect(dayEdit, &QDateEdit::dateChanged, this, [this] { reload(); });
+}
+
+void DashboardScreen::reload() {
+  const auto gen = ++generation;
+  const auto day = dayEdit->date();
+
+  pool->read([day](Database &d) {
+      DashboardData data;
+      data.statuses = d.orderStatusCounts();
+      if (d.lastError().isEmpty()) {
+        data.products = d.productTotalsForDay(day, kTopRows);
+      }
+      if (d.lastError().isEmpty()) {
+        data.customers = d.topCustomers(kTopRows);
+      }
+      data.error = d.lastError();
+      return data;
+    }).then(this, [this, gen](DbResult<DashboardData> r) {
+    if (gen != generation) {
+      return;
+    }
+
+    const auto &data = r.value;
+    errorLabel->setText(data.error);
+    errorLabel->setVisible(!data.error.isEmpty());
+
+    long long total = 0;
+    statusTable->setRowCount(static_cast<int>(data.statuses.size()));
+    for (int i = 0; i < static_cast<int>(data.statuses.size()); ++i) {
+      const auto &s = data.statuses[static_cast<std::size_t>(i)];
+      total += s.orders;
+      setRow(statusTable, i,
+             {orderStatusName(s.status), QString::number(s.orders)});
+    }
+    totalValue->setText(QString::number(total));
+
+    productTable->setRowCount(static_cast<int>(data.products.size()));
+    for (int i = 0; i < static_cast<int>(data.products.size()); ++i) {
+      const auto &p = data.products[static_cast<std::size_t>(i)];
+      setRow(productTable, i,
+             {p.product, QString::number(p.orders),
+              QString::number(p.quantity)});
+    }
+
+    customerTable->setRowCount(static_cast<int>(data.customers.size()));
+    for (int i = 0; i < static_cast<int>(data.customers.size()); ++i) {
+      const auto &c = data.customers[static_cast<std::size_t>(i)];
+      setRow(customerTable, i, {c.customer, QString::number(c.orders)});
+    }
+  });
+}
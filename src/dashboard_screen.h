@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QDateEdit>
+#include <QLabel>
+#include <QTableWidget>
+#include <QWidget>
+
+#include "connection_pool.h"
+
+// Order statistics read from the summary tables: totals by status, the
+// day's top products and the customers with the most orders.
+class DashboardScreen final : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit DashboardScreen(ConnectionPool *pool, QWidget *parent = nullptr);
+
+  // Re-reads the summaries in the background.
+  void reload();
+
+private:
+  static constexpr int kTopRows = 10;
+
+  ConnectionPool *pool;
+  quint64 generation = 0;
+
+  QLabel *totalValue;
+  QLabel *errorLabel;
+  QTableWidget *statusTable;
+  QDateEdit *dayEdit;
+  QTableWidget *productTable;
+  QTableWidget *customerTable;
+};
@@ -1,86 +1,112 @@
 #include "database.h"
+#include "embedded_migrations.h"
 #include "models.h"
+#include "password_hash.h"
+#include "query_log.h"
+#include "trace.h"
 
-#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
-#include <QFile>
+#include <QElapsedTimer>
 #include <QFileInfo>
-#include <QRandomGenerator>
+#include <QRegularExpression>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QStandardPaths>
-#include <QTextStream>
 #include <QVariant>
+#include <array>
 #include <optional>
-#include <print>
+
+#ifdef LOGISTICS_SQLITE_INTERRUPT
+#include <QSqlDriver>
+#include <sqlite3.h>
+#endif
 
 namespace {
-struct Migration {
-  int version = 0;
-  QString resourcePath;
-};
+// EXPLAIN QUERY PLAN details for the statement `q` last ran, with the same
+// bound values.
+QStringList explainQueryPlan(const QSqlQuery &q, const QString &connName) {
+  static const QRegularExpression explainable(
+      R"(^\s*(SELECT|INSERT|UPDATE|DELETE|WITH)\b)",
+      QRegularExpression::CaseInsensitiveOption);
+  const auto sql = q.lastQuery();
+  if (!explainable.match(sql).hasMatch()) {
+    return {};
+  }
 
-QString readResource(const QString &path, QString &err) {
-  QFile file(path);
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    err = "Failed to open migration resource: " + path;
+  QSqlQuery explain(QSqlDatabase::database(connName, false));
+  if (!explain.prepare("EXPLAIN QUERY PLAN " + sql)) {
     return {};
   }
+  for (const auto &value : q.boundValues()) {
+    explain.addBindValue(value);
+  }
 
-  QTextStream in(&file);
-  return in.readAll();
+  QStringList plan;
+  if (explain.exec()) {
+    while (explain.next()) {
+      plan << explain.value(3).toString();
+    }
+  }
+  return plan;
 }
 
-QStringList splitSqlStatements(const QString &sql) {
-  QStringList statements;
-  QString buffer;
-  bool inSingleQuote = false;
-
-  for (int i = 0; i < sql.size(); ++i) {
-    const auto c = sql.at(i);
+// Times a statement from just before exec() until the caller is done with
+// its rows, then reports it to the query log. Declare it after any
+// StatementLease on the same query so it reports before the reset.
+class QueryTrace final {
+public:
+  QueryTrace(const QSqlQuery &q, const QString &connName)
+      : q(q), connName(connName) {
+    timer.start();
+  }
 
-    if (c == '\'' && (i == 0 || sql.at(i - 1) != '\\')) {
-      inSingleQuote = !inSingleQuote;
+  ~QueryTrace() {
+    auto &log = QueryLog::instance();
+    const double ms = static_cast<double>(timer.nsecsElapsed()) / 1e6;
+    if (!log.shouldLog(ms)) {
+      return;
     }
 
-    if (!inSingleQuote && c == ';') {
-      const auto stmt = buffer.trimmed();
-      if (!stmt.isEmpty()) {
-        statements.push_back(stmt);
-      }
-      buffer.clear();
-      continue;
+    QueryLogEntry entry;
+    entry.connection = connName;
+    entry.sql = QueryLog::normalizeSql(q.lastQuery());
+    entry.ms = ms;
+    entry.rows = q.isSelect() ? rows : q.numRowsAffected();
+    entry.slow = log.isSlow(ms);
+    if (entry.slow) {
+      entry.plan = explainQueryPlan(q, connName);
+      entry.fullScans = QueryLog::fullScans(entry.plan);
     }
-
-    buffer.append(c);
+    log.write(entry);
   }
 
-  const auto tail = buffer.trimmed();
-  if (!tail.isEmpty()) {
-    statements.push_back(tail);
-  }
+  QueryTrace(const QueryTrace &) = delete;
+  QueryTrace &operator=(const QueryTrace &) = delete;
 
-  return statements;
-}
+  void row() { ++rows; }
 
-bool applyMigration(const Migration &m, QString &err) {
-  const auto sql = readResource(m.resourcePath, err);
-  if (sql.isEmpty()) {
-    return false;
-  }
+private:
+  const QSqlQuery &q;
+  QString connName;
+  QElapsedTimer timer;
+  long long rows = 0;
+};
 
-  const auto statements = splitSqlStatements(sql);
-  QSqlQuery q;
-  for (const auto &stmt : statements) {
-    if (!q.exec(stmt)) {
+bool applyMigration(const QSqlDatabase &db,
+                    const embedded_migrations::Migration &m, QString &err) {
+  QSqlQuery q(db);
+  for (const auto stmt : m.statements) {
+    QueryTrace trace(q, db.connectionName());
+    if (!q.exec(QString::fromUtf8(stmt.data(),
+                                  static_cast<qsizetype>(stmt.size())))) {
       err = q.lastError().text();
       return false;
     }
   }
 
-  QSqlQuery setVersion;
+  QSqlQuery setVersion(db);
   if (!setVersion.exec(QString("PRAGMA user_version = %1").arg(m.version))) {
     err = setVersion.lastError().text();
     return false;
@@ -89,31 +115,187 @@ bool applyMigration(const Migration &m, QString &err) {
   return true;
 }
 
-QString randomSaltHex(int bytes = 16) {
-  QByteArray buf;
-  buf.resize(bytes);
-  for (int i = 0; i < bytes; ++i) {
-    buf[i] = static_cast<char>(QRandomGenerator::global()->generate() & 0xFF);
+constexpr std::array<const char *, 6> kOrderColumns = {
+    "id", "customer", "product", "quantity", "status", "order_date"};
+
+QString orderColumnName(int column) {
+  if (column < 0 || column >= static_cast<int>(kOrderColumns.size())) {
+    return "id";
   }
-  return QString::fromLatin1(buf.toHex());
+  return kOrderColumns[column];
 }
 
-QString saltedSha256Hex(const QString &saltHex, const QString &password) {
-  const QByteArray input = (saltHex + ":" + password).toUtf8();
-  return QString::fromLatin1(
-      QCryptographicHash::hash(input, QCryptographicHash::Sha256).toHex());
+constexpr int kOrderInsertColumns = 5;
+// Rows per multi-row INSERT; keeps the bound parameters well below
+// SQLite's host parameter limit.
+constexpr int kInsertBatchRows = 64;
+
+constexpr const char *kInsertOrderSql = R"SQL(
+    INSERT INTO orders (customer, product, quantity, status, order_date)
+    VALUES (?, ?, ?, ?, ?)
+  )SQL";
+
+QByteArray insertOrdersSql(int rows) {
+  QByteArray sql = "INSERT INTO orders (customer, product, quantity, status, "
+                   "order_date) VALUES ";
+  for (int i = 0; i < rows; ++i) {
+    sql += i == 0 ? "(?, ?, ?, ?, ?)" : ", (?, ?, ?, ?, ?)";
+  }
+  return sql;
+}
+
+// Rows per multi-row INSERT into the temp table of ids for a bulk change.
+constexpr int kStageBatchRows = 256;
+
+QByteArray stageIdsSql(int rows) {
+  QByteArray sql = "INSERT OR IGNORE INTO temp.bulk_ids (id) VALUES ";
+  for (int i = 0; i < rows; ++i) {
+    sql += i == 0 ? "(?)" : ", (?)";
+  }
+  return sql;
+}
+
+void bindOrder(QSqlQuery &q, int first, const OrderDraft &o) {
+  q.bindValue(first, o.customer);
+  q.bindValue(first + 1, o.product);
+  q.bindValue(first + 2, o.quantity);
+  q.bindValue(first + 3, static_cast<int>(o.status));
+  // Stored as the Julian day number; julianday() in SQL is this - 0.5.
+  q.bindValue(first + 4, o.orderDate.toJulianDay());
+}
+
+// Resets a cached statement once a call is done with it, so it does not
+// keep a read transaction open until its next use.
+class StatementLease final {
+public:
+  explicit StatementLease(QSqlQuery &q) : q(q) {}
+  ~StatementLease() { q.finish(); }
+
+  StatementLease(const StatementLease &) = delete;
+  StatementLease &operator=(const StatementLease &) = delete;
+
+private:
+  QSqlQuery &q;
+};
+
+// SELECT over orders matching `query`, ordered by (sort column, id). With
+// `afterCursor` it also binds the keyset position to continue from: the
+// sort value (unless sorting by id), then the id.
+QString selectOrdersSql(const OrderQuery &query, bool afterCursor) {
+  // Keyset paging: with id as tie-breaker the position after the last row
+  // read is unique and can seek through the index instead of walking an
+  // OFFSET from the top of the table.
+  const auto column = orderColumnName(query.sortColumn);
+  const bool byId = column == "id";
+  const bool desc = query.sortOrder == Qt::DescendingOrder;
+  const QString dir = desc ? "DESC" : "ASC";
+
+  QStringList where;
+  if (!query.filter.isEmpty()) {
+    where << "(" + query.filter + ")";
+  }
+  if (afterCursor) {
+    const QString cmp = desc ? "<" : ">";
+    where << (byId ? QString("id %1 ?").arg(cmp)
+                   : QString("(%1, id) %2 (?, ?)").arg(column, cmp));
+  }
+
+  QString sql = "SELECT id, customer, product, quantity, status, order_date "
+                "FROM orders";
+  if (!where.isEmpty()) {
+    sql += " WHERE " + where.join(" AND ");
+  }
+  sql += byId ? QString(" ORDER BY id %1").arg(dir)
+              : QString(" ORDER BY %1 %2, id %2").arg(column, dir);
+  return sql;
+}
+
+struct ProfileSettings {
+  const char *journalMode;
+  const char *synchronous;
+  int cacheSizeKiB;
+  qint64 mmapSize;
+  const char *tempStore;
+  int busyTimeoutMs;
+  bool queryOnly;
+};
+
+// All profiles use WAL: the journal mode is a property of the file, not of
+// the connection, and WAL lets readers keep going while a writer commits.
+ProfileSettings profileSettings(ConnectionProfile profile) {
+  switch (profile) {
+  case ConnectionProfile::BulkIngest:
+    return {"WAL", "OFF", 256 * 1024, 0, "MEMORY", 30'000, false};
+  case ConnectionProfile::ReadOnlyReporting:
+    return {"WAL", "NORMAL", 128 * 1024, qint64(1) << 30, "MEMORY", 5'000,
+            true};
+  case ConnectionProfile::Interactive:
+    break;
+  }
+  return {"WAL", "NORMAL", 16 * 1024, qint64(256) << 20, "MEMORY", 5'000,
+          false};
+}
+
+OrderRow readOrderRow(const QSqlQuery &q) {
+  OrderRow r;
+  r.id = q.value(0).toLongLong();
+  r.customer = q.value(1).toString();
+  r.product = q.value(2).toString();
+  r.quantity = q.value(3).toInt();
+  r.status = static_cast<OrderStatus>(q.value(4).toInt());
+  r.orderDate = QDate::fromJulianDay(q.value(5).toLongLong());
+  return r;
 }
 
 } // namespace
 
 
+QString connectionProfileName(ConnectionProfile profile) {
+  switch (profile) {
+  case ConnectionProfile::BulkIngest:
+    return "bulk-ingest";
+  case ConnectionProfile::ReadOnlyReporting:
+    return "reporting";
+  case ConnectionProfile::Interactive:
+    break;
+  }
+  return "interactive";
+}
+
+std::optional<ConnectionProfile>
+connectionProfileFromName(const QString &name) {
+  for (auto profile :
+       {ConnectionProfile::Interactive, ConnectionProfile::BulkIngest,
+        ConnectionProfile::ReadOnlyReporting}) {
+    if (name.compare(connectionProfileName(profile), Qt::CaseInsensitive) ==
+        0) {
+      return profile;
+    }
+  }
+  return std::nullopt;
+}
+
+Database::Database(const QString &connectionName, const QString &path)
+    : connName(connectionName.isEmpty()
+                   ? QString::fromLatin1(QSqlDatabase::defaultConnection)
+                   : connectionName),
+      filePath(path) {}
+
+QSqlDatabase Database::connection() const {
+  return QSqlDatabase::database(connName, false);
+}
+
 QString Database::dbPath() const {
+  if (!filePath.isEmpty()) {
+    return filePath;
+  }
   const auto baseDir =
       QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
   return QDir(baseDir).filePath("logistics.sqlite");
 }
 
-bool Database::open() {
+bool Database::open(ConnectionProfile profile) {
+  TRACE_SCOPE("Database::open", "db");
   lastErr.clear();
 
   if (!QSqlDatabase::isDriverAvailable("QSQLITE")) {
@@ -126,7 +308,7 @@ bool Database::open() {
   QDir().mkpath(QFileInfo(path).absolutePath());
   qDebug().noquote() << "SQLite DB path:" << path;
 
-  auto db = QSqlDatabase::addDatabase("QSQLITE");
+  auto db = QSqlDatabase::addDatabase("QSQLITE", connName);
   db.setDatabaseName(path);
 
   if (!db.open()) {
@@ -134,13 +316,152 @@ bool Database::open() {
     return false;
   }
 
+#ifdef LOGISTICS_SQLITE_INTERRUPT
+  if (const auto handle = db.driver()->handle();
+      handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+    sqliteHandle = *static_cast<sqlite3 *const *>(handle.constData());
+  }
+#endif
+
+  return applyProfile(profile);
+}
+
+void Database::interrupt() {
+#ifdef LOGISTICS_SQLITE_INTERRUPT
+  if (auto *handle = static_cast<sqlite3 *>(sqliteHandle.load())) {
+    sqlite3_interrupt(handle);
+  }
+#endif
+}
+
+bool Database::applyProfile(ConnectionProfile profile) {
+  TRACE_SCOPE("Database::applyProfile", "db");
+  lastErr.clear();
+
+  const auto s = profileSettings(profile);
+  // Negative cache_size is in KiB rather than pages.
+  const QStringList pragmas = {
+      QString("PRAGMA journal_mode = %1").arg(s.journalMode),
+      QString("PRAGMA synchronous = %1").arg(s.synchronous),
+      QString("PRAGMA cache_size = -%1").arg(s.cacheSizeKiB),
+      QString("PRAGMA mmap_size = %1").arg(s.mmapSize),
+      QString("PRAGMA temp_store = %1").arg(s.tempStore),
+      QString("PRAGMA busy_timeout = %1").arg(s.busyTimeoutMs),
+      QString("PRAGMA query_only = %1").arg(s.queryOnly ? "ON" : "OFF"),
+  };
+
+  QSqlQuery q(connection());
+  for (const auto &pragma : pragmas) {
+    if (!q.exec(pragma)) {
+      lastErr = QString("%1: %2").arg(pragma, q.lastError().text());
+      return false;
+    }
+  }
+
+  // Log what SQLite actually uses: it may ignore a setting (mmap_size is
+  // capped at compile time, journal_mode cannot change on a busy file).
+  QStringList effective;
+  for (const char *name :
+       {"journal_mode", "synchronous", "cache_size", "mmap_size", "temp_store",
+        "busy_timeout", "query_only"}) {
+    if (q.exec(QString("PRAGMA %1").arg(name)) && q.next()) {
+      effective << QString("%1=%2").arg(QString::fromLatin1(name),
+                                          q.value(0).toString());
+    }
+  }
+  q.finish();
+  qInfo().noquote() << QString("SQLite profile %1 on %2:")
+                           .arg(connectionProfileName(profile), connName)
+                    << effective.join(' ');
+
+  activeProfile = profile;
+  return true;
+}
+
+ScopedProfile::ScopedProfile(Database &db, ConnectionProfile profile)
+    : db(db), previous(db.profile()) {
+  if (profile == previous) {
+    return;
+  }
+  // A failed PRAGMA may leave the profile half applied, so restore even
+  // then.
+  switched = true;
+  applied = db.applyProfile(profile);
+  if (!applied) {
+    qWarning().noquote()
+        << QString("Failed to switch %1 to profile %2:")
+               .arg(db.connName, connectionProfileName(profile))
+        << db.lastErr;
+  }
+}
+
+ScopedProfile::~ScopedProfile() {
+  if (!switched) {
+    return;
+  }
+  const auto err = db.lastErr;
+  if (!db.applyProfile(previous)) {
+    qWarning().noquote()
+        << QString("Failed to restore profile %1 on %2:")
+               .arg(connectionProfileName(previous), db.connName)
+        << db.lastErr;
+  }
+  db.lastErr = err;
+}
+
+QSqlQuery *Database::prepared(Statement id, const char *sql) {
+  if (auto it = statements.find(id); it != statements.end()) {
+    ++statementStats.hits;
+    return &it->second;
+  }
+
+  ++statementStats.misses;
+  QSqlQuery q(connection());
+  if (!q.prepare(QString::fromUtf8(sql))) {
+    lastErr = q.lastError().text();
+    return nullptr;
+  }
+  return &statements.emplace(id, std::move(q)).first->second;
+}
+
+bool Database::beginRead() {
+  lastErr.clear();
+  auto db = connection();
+  if (!db.transaction()) {
+    lastErr = db.lastError().text();
+    return false;
+  }
   return true;
 }
 
+void Database::endRead() {
+  // Nothing was written, so a failed COMMIT loses nothing; keep the error
+  // of the reads themselves.
+  auto db = connection();
+  if (!db.commit()) {
+    qWarning().noquote() << "Failed to end read transaction:"
+                         << db.lastError().text();
+    db.rollback();
+  }
+}
+
+void Database::close() {
+  sqliteHandle = nullptr;
+  statements.clear();
+  {
+    auto db = connection();
+    if (db.isOpen()) {
+      db.close();
+    }
+  }
+  QSqlDatabase::removeDatabase(connName);
+}
+
 bool Database::migrate() {
+  TRACE_SCOPE("Database::migrate", "db");
   lastErr.clear();
 
-  QSqlQuery q;
+  QSqlQuery q(connection());
   if (!q.exec("PRAGMA user_version")) {
     lastErr = q.lastError().text();
     return false;
@@ -151,25 +472,27 @@ bool Database::migrate() {
     currentVersion = q.value(0).toInt();
   }
 
-  const std::vector<Migration> migrations = {
-      {1, ":/migrations/001_init.sql"},
-      {2, ":/migrations/002_indexes.sql"},
-      {3, ":/migrations/003_users.sql"},
-  };
+  // Fast path for every launch after the first: the schema is current.
+  if (currentVersion >= embedded_migrations::kLatestVersion) {
+    return true;
+  }
 
-  auto db = QSqlDatabase::database();
-  for (const auto &m : migrations) {
+  auto db = connection();
+  for (const auto &m : embedded_migrations::kMigrations) {
     if (m.version <= currentVersion) {
       continue;
     }
 
+    // Statements compiled against the old schema must not outlive it.
+    statements.clear();
+
     if (!db.transaction()) {
       lastErr = db.lastError().text();
       return false;
     }
 
     QString err;
-    if (!applyMigration(m, err)) {
+    if (!applyMigration(db, m, err)) {
       db.rollback();
       lastErr = err;
       return false;
@@ -187,33 +510,98 @@ bool Database::migrate() {
 }
 
 std::optional<long long> Database::insertOrder(const OrderDraft &o) {
+  TRACE_SCOPE("Database::insertOrder", "db");
   lastErr.clear();
 
-  QSqlQuery q;
-  q.prepare(R"SQL(
-    INSERT INTO orders (customer, product, quantity, status, order_date)
-    VALUES (?, ?, ?, ?, ?)
-  )SQL");
-  q.addBindValue(o.customer);
-  q.addBindValue(o.product);
-  q.addBindValue(o.quantity);
-  q.addBindValue(o.status);
-  q.addBindValue(o.orderDate.toString(Qt::ISODate));
+  auto *q = prepared(Statement::InsertOrder, kInsertOrderSql);
+  if (!q) {
+    return std::nullopt;
+  }
+  StatementLease lease(*q);
+  bindOrder(*q, 0, o);
 
-  if (!q.exec()) {
-    lastErr = q.lastError().text();
+  QueryTrace trace(*q, connName);
+  if (!q->exec()) {
+    lastErr = q->lastError().text();
     return std::nullopt;
   }
 
-  return q.lastInsertId().toLongLong();
+  return q->lastInsertId().toLongLong();
+}
+
+bool Database::insertOrders(const std::vector<OrderDraft> &orders) {
+  TRACE_SCOPE("Database::insertOrders", "db");
+  lastErr.clear();
+
+  if (orders.empty()) {
+    return true;
+  }
+
+  auto db = connection();
+  if (!db.transaction()) {
+    lastErr = db.lastError().text();
+    return false;
+  }
+
+  auto fail = [&](const QString &err) {
+    lastErr = err;
+    db.rollback();
+    return false;
+  };
+
+  std::size_t i = 0;
+  const auto n = orders.size();
+
+  if (n >= kInsertBatchRows) {
+    static const QByteArray batchSql = insertOrdersSql(kInsertBatchRows);
+    auto *q = prepared(Statement::InsertOrderBatch, batchSql.constData());
+    if (!q) {
+      return fail(lastErr);
+    }
+    StatementLease lease(*q);
+
+    for (; i + kInsertBatchRows <= n; i += kInsertBatchRows) {
+      for (int r = 0; r < kInsertBatchRows; ++r) {
+        bindOrder(*q, r * kOrderInsertColumns, orders[i + r]);
+      }
+      QueryTrace trace(*q, connName);
+      if (!q->exec()) {
+        return fail(q->lastError().text());
+      }
+    }
+  }
+
+  if (i < n) {
+    auto *q = prepared(Statement::InsertOrder, kInsertOrderSql);
+    if (!q) {
+      return fail(lastErr);
+    }
+    StatementLease lease(*q);
+
+    for (; i < n; ++i) {
+      bindOrder(*q, 0, orders[i]);
+      QueryTrace trace(*q, connName);
+      if (!q->exec()) {
+        return fail(q->lastError().text());
+      }
+    }
+  }
+
+  if (!db.commit()) {
+    return fail(db.lastError().text());
+  }
+
+  return true;
 }
 
 std::vector<OrderRow> Database::listOrders() {
+  TRACE_SCOPE("Database::listOrders", "db");
   lastErr.clear();
 
   std::vector<OrderRow> out;
 
-  QSqlQuery q;
+  QSqlQuery q(connection());
+  QueryTrace trace(q, connName);
   if (!q.exec(R"SQL(
     SELECT id, customer, product, quantity, status, order_date
     FROM orders
@@ -224,64 +612,452 @@ std::vector<OrderRow> Database::listOrders() {
   }
 
   while (q.next()) {
-    OrderRow r;
-    r.id = q.value(0).toLongLong();
-    r.customer = q.value(1).toString();
-    r.product = q.value(2).toString();
-    r.quantity = q.value(3).toInt();
-    r.status = q.value(4).toString();
-    r.orderDate = QDate::fromString(q.value(5).toString(), Qt::ISODate);
-    out.push_back(std::move(r));
+    trace.row();
+    out.push_back(readOrderRow(q));
   }
 
   return out;
 }
 
-std::optional<OrderRow> Database::getOrder(long long orderId) {
+std::optional<long long> Database::countOrders(const OrderQuery &query) {
+  TRACE_SCOPE("Database::countOrders", "db");
+  lastErr.clear();
+
+  QString sql = "SELECT COUNT(*) FROM orders";
+  if (!query.filter.isEmpty()) {
+    sql += " WHERE " + query.filter;
+  }
+
+  QSqlQuery q(connection());
+  QueryTrace trace(q, connName);
+  if (!q.exec(sql)) {
+    lastErr = q.lastError().text();
+    return std::nullopt;
+  }
+  if (!q.next()) {
+    return 0;
+  }
+  trace.row();
+  return q.value(0).toLongLong();
+}
+
+std::vector<OrderRow>
+Database::listOrdersPage(const OrderQuery &query,
+                         const std::optional<OrderCursor> &after,
+                         long long skip, int limit) {
+  TRACE_SCOPE("Database::listOrdersPage", "db");
+  lastErr.clear();
+
+  std::vector<OrderRow> out;
+
+  const bool byId = orderColumnName(query.sortColumn) == "id";
+  const auto sql =
+      selectOrdersSql(query, after.has_value()) + " LIMIT ? OFFSET ?";
+
+  QSqlQuery q(connection());
+  q.setForwardOnly(true);
+  q.prepare(sql);
+  if (after) {
+    if (!byId) {
+      q.addBindValue(after->sortValue);
+    }
+    q.addBindValue(after->id);
+  }
+  q.addBindValue(limit);
+  q.addBindValue(skip);
+
+  QueryTrace trace(q, connName);
+  if (!q.exec()) {
+    lastErr = q.lastError().text();
+    return out;
+  }
+
+  out.reserve(limit);
+  while (q.next()) {
+    trace.row();
+    out.push_back(readOrderRow(q));
+  }
+
+  return out;
+}
+
+std::vector<OrderRow>
+Database::matchingOrders(const OrderQuery &query,
+                         const std::vector<long long> &ids) {
+  TRACE_SCOPE("Database::matchingOrders", "db");
+  lastErr.clear();
+
+  std::vector<OrderRow> out;
+  if (ids.empty()) {
+    return out;
+  }
+
+  auto placeholders =
+      QString("?,").repeated(static_cast<qsizetype>(ids.size()));
+  placeholders.chop(1);
+  QString sql = "SELECT id, customer, product, quantity, status, order_date "
+                "FROM orders WHERE id IN (" +
+                placeholders + ")";
+  if (!query.filter.isEmpty()) {
+    sql += " AND (" + query.filter + ")";
+  }
+
+  QSqlQuery q(connection());
+  q.setForwardOnly(true);
+  q.prepare(sql);
+  for (const auto id : ids) {
+    q.addBindValue(id);
+  }
+  QueryTrace trace(q, connName);
+  if (!q.exec()) {
+    lastErr = q.lastError().text();
+    return out;
+  }
+
+  out.reserve(ids.size());
+  while (q.next()) {
+    trace.row();
+    out.push_back(readOrderRow(q));
+  }
+  return out;
+}
+
+bool Database::forEachOrder(
+    const OrderQuery &query,
+    const std::function<bool(const OrderRow &)> &visit) {
+  TRACE_SCOPE("Database::forEachOrder", "db");
+  lastErr.clear();
+
+  // Forward-only: the driver hands rows over one at a time instead of
+  // caching the result set for backwards navigation.
+  QSqlQuery q(connection());
+  q.setForwardOnly(true);
+  QueryTrace trace(q, connName);
+  if (!q.exec(selectOrdersSql(query, false))) {
+    lastErr = q.lastError().text();
+    return false;
+  }
+
+  while (q.next()) {
+    trace.row();
+    if (!visit(readOrderRow(q))) {
+      break;
+    }
+  }
+
+  if (q.lastError().isValid()) {
+    lastErr = q.lastError().text();
+    return false;
+  }
+  return true;
+}
+
+std::vector<StatusCount> Database::orderStatusCounts() {
+  TRACE_SCOPE("Database::orderStatusCounts", "db");
+  lastErr.clear();
+
+  std::vector<StatusCount> out;
+
+  QSqlQuery q(connection());
+  QueryTrace trace(q, connName);
+  if (!q.exec("SELECT status, orders FROM order_status_counts "
+              "ORDER BY status")) {
+    lastErr = q.lastError().text();
+    return out;
+  }
+
+  while (q.next()) {
+    trace.row();
+    out.push_back({static_cast<OrderStatus>(q.value(0).toInt()),
+                   q.value(1).toLongLong()});
+  }
+
+  return out;
+}
+
+std::vector<ProductDayTotal> Database::productTotalsForDay(const QDate &day,
+                                                           int limit) {
+  TRACE_SCOPE("Database::productTotalsForDay", "db");
+  lastErr.clear();
+
+  std::vector<ProductDayTotal> out;
+
+  QSqlQuery q(connection());
+  q.prepare(R"SQL(
+    SELECT product, orders, quantity
+    FROM product_daily_totals
+    WHERE order_date = ?
+    ORDER BY quantity DESC
+    LIMIT ?
+  )SQL");
+  q.addBindValue(day.toJulianDay());
+  q.addBindValue(limit);
+
+  QueryTrace trace(q, connName);
+  if (!q.exec()) {
+    lastErr = q.lastError().text();
+    return out;
+  }
+
+  while (q.next()) {
+    trace.row();
+    out.push_back({q.value(0).toString(), day, q.value(1).toLongLong(),
+                   q.value(2).toLongLong()});
+  }
+
+  return out;
+}
+
+std::vector<CustomerOrderCount> Database::topCustomers(int limit) {
+  TRACE_SCOPE("Database::topCustomers", "db");
   lastErr.clear();
-  std::println("Fetching order {}", orderId);
 
-  QSqlQuery q;
+  std::vector<CustomerOrderCount> out;
+
+  QSqlQuery q(connection());
   q.prepare(R"SQL(
+    SELECT customer, orders
+    FROM customer_order_counts
+    ORDER BY orders DESC
+    LIMIT ?
+  )SQL");
+  q.addBindValue(limit);
+
+  QueryTrace trace(q, connName);
+  if (!q.exec()) {
+    lastErr = q.lastError().text();
+    return out;
+  }
+
+  while (q.next()) {
+    trace.row();
+    out.push_back({q.value(0).toString(), q.value(1).toLongLong()});
+  }
+
+  return out;
+}
+
+std::vector<ValueFrequency> Database::customerFrequencies() {
+  TRACE_SCOPE("Database::customerFrequencies", "db");
+  lastErr.clear();
+
+  std::vector<ValueFrequency> out;
+
+  QSqlQuery q(connection());
+  q.setForwardOnly(true);
+  QueryTrace trace(q, connName);
+  if (!q.exec("SELECT customer, orders FROM customer_order_counts")) {
+    lastErr = q.lastError().text();
+    return out;
+  }
+
+  while (q.next()) {
+    trace.row();
+    out.push_back({q.value(0).toString(), q.value(1).toLongLong()});
+  }
+
+  return out;
+}
+
+std::vector<ValueFrequency> Database::productFrequencies() {
+  TRACE_SCOPE("Database::productFrequencies", "db");
+  lastErr.clear();
+
+  std::vector<ValueFrequency> out;
+
+  // Walks the (product, order_date) primary key, so the grouping needs no
+  // sort.
+  QSqlQuery q(connection());
+  q.setForwardOnly(true);
+  QueryTrace trace(q, connName);
+  if (!q.exec(R"SQL(
+    SELECT product, SUM(orders)
+    FROM product_daily_totals
+    GROUP BY product
+  )SQL")) {
+    lastErr = q.lastError().text();
+    return out;
+  }
+
+  while (q.next()) {
+    trace.row();
+    out.push_back({q.value(0).toString(), q.value(1).toLongLong()});
+  }
+
+  return out;
+}
+
+std::optional<ChangeFeed> Database::changesSince(long long since,
+                                                int limit) {
+  TRACE_SCOPE("Database::changesSince", "db");
+  lastErr.clear();
+
+  QSqlQuery range(connection());
+  {
+    QueryTrace trace(range, connName);
+    if (!range.exec("SELECT MIN(seq), MAX(seq) FROM orders_changelog") ||
+        !range.next()) {
+      lastErr = range.lastError().text();
+      return std::nullopt;
+    }
+  }
+  ChangeFeed feed;
+  feed.lastSeq = since;
+  if (range.value(0).isNull()) {
+    feed.lastSeq = 0;
+    feed.complete = since == 0;
+    return feed;
+  }
+  const auto oldest = range.value(0).toLongLong();
+  const auto newest = range.value(1).toLongLong();
+  range.finish();
+  // Entries up to oldest - 1 have been pruned; a position past the end
+  // means the log was reset.
+  if (since < oldest - 1 || since > newest) {
+    feed.lastSeq = newest;
+    feed.complete = false;
+    return feed;
+  }
+
+  QSqlQuery q(connection());
+  q.setForwardOnly(true);
+  if (!q.prepare(R"SQL(
+    SELECT seq, order_id, kind
+    FROM orders_changelog
+    WHERE seq > ?
+    ORDER BY seq
+    LIMIT ?
+  )SQL")) {
+    lastErr = q.lastError().text();
+    return std::nullopt;
+  }
+  q.addBindValue(since);
+  q.addBindValue(limit + 1);
+
+  QueryTrace trace(q, connName);
+  if (!q.exec()) {
+    lastErr = q.lastError().text();
+    return std::nullopt;
+  }
+  while (q.next()) {
+    trace.row();
+    if (static_cast<int>(feed.changes.size()) == limit) {
+      feed.lastSeq = newest;
+      feed.complete = false;
+      feed.changes.clear();
+      return feed;
+    }
+    const auto kind = q.value(2).toInt();
+    if (kind < 0 || kind > static_cast<int>(OrderChange::Kind::Deleted)) {
+      continue;
+    }
+    feed.lastSeq = q.value(0).toLongLong();
+    feed.changes.push_back(
+        {static_cast<OrderChange::Kind>(kind), q.value(1).toLongLong()});
+  }
+  return feed;
+}
+
+std::optional<long long> Database::latestChange() {
+  TRACE_SCOPE("Database::latestChange", "db");
+  lastErr.clear();
+
+  QSqlQuery q(connection());
+  QueryTrace trace(q, connName);
+  if (!q.exec("SELECT COALESCE(MAX(seq), 0) FROM orders_changelog") ||
+      !q.next()) {
+    lastErr = q.lastError().text();
+    return std::nullopt;
+  }
+  return q.value(0).toLongLong();
+}
+
+std::optional<long long> Database::pruneChangelog(long long keep,
+                                                  long long limit) {
+  TRACE_SCOPE("Database::pruneChangelog", "db");
+  lastErr.clear();
+
+  // A range of the primary key from the oldest entry, so a batch costs
+  // the same however long the log is.
+  QSqlQuery q(connection());
+  if (!q.prepare(R"SQL(
+    DELETE FROM orders_changelog
+    WHERE seq <= MIN((SELECT MAX(seq) FROM orders_changelog) - ?,
+                     (SELECT MIN(seq) FROM orders_changelog) + ? - 1)
+  )SQL")) {
+    lastErr = q.lastError().text();
+    return std::nullopt;
+  }
+  q.addBindValue(keep);
+  q.addBindValue(limit);
+
+  QueryTrace trace(q, connName);
+  if (!q.exec()) {
+    lastErr = q.lastError().text();
+    return std::nullopt;
+  }
+  return q.numRowsAffected();
+}
+
+std::optional<long long> Database::dataVersion() {
+  lastErr.clear();
+
+  QSqlQuery q(connection());
+  if (!q.exec("PRAGMA data_version") || !q.next()) {
+    lastErr = q.lastError().text();
+    return std::nullopt;
+  }
+  return q.value(0).toLongLong();
+}
+
+std::optional<OrderRow> Database::getOrder(long long orderId) {
+  TRACE_SCOPE("Database::getOrder", "db");
+  lastErr.clear();
+
+  auto *q = prepared(Statement::GetOrder, R"SQL(
             select id, customer, product, quantity, status, order_date
             from orders
             where id = ?
             limit 1
             )SQL");
-  q.addBindValue(orderId);
+  if (!q) {
+    return std::nullopt;
+  }
+  StatementLease lease(*q);
+  q->bindValue(0, orderId);
 
-  if (!q.exec()) {
-    lastErr = q.lastError().text();
+  QueryTrace trace(*q, connName);
+  if (!q->exec()) {
+    lastErr = q->lastError().text();
     return std::nullopt;
   }
 
-  if (!q.next()) {
+  if (!q->next()) {
     return std::nullopt;
   }
+  trace.row();
 
-  OrderRow r;
-  r.id = q.value(0).toLongLong();
-  r.customer = q.value(1).toString();
-  r.product = q.value(2).toString();
-  r.quantity = q.value(3).toInt();
-  r.status = q.value(4).toString();
-  r.orderDate = QDate::fromString(q.value(5).toString(), Qt::ISODate);
-  return r;
+  return readOrderRow(*q);
 }
 
 bool Database::deleteOrder(long long orderId) {
+  TRACE_SCOPE("Database::deleteOrder", "db");
   lastErr.clear();
 
-  QSqlQuery q;
-  q.prepare("delete from orders where id = ?");
-  q.addBindValue(orderId);
+  auto *q = prepared(Statement::DeleteOrder, "delete from orders where id = ?");
+  if (!q) {
+    return false;
+  }
+  StatementLease lease(*q);
+  q->bindValue(0, orderId);
 
-  if (!q.exec()) {
-    lastErr = q.lastError().text();
+  QueryTrace trace(*q, connName);
+  if (!q->exec()) {
+    lastErr = q->lastError().text();
     return false;
   }
 
-  if (q.numRowsAffected() == 0) {
+  if (q->numRowsAffected() == 0) {
     lastErr = "Order not found.";
     return false;
   }
@@ -290,82 +1066,304 @@ bool Database::deleteOrder(long long orderId) {
 };
 
 bool Database::updateOrder(long long orderId, const OrderDraft &o) {
+  TRACE_SCOPE("Database::updateOrder", "db");
   lastErr.clear();
 
-  QSqlQuery q;
-  q.prepare(R"sql(
+  auto *q = prepared(Statement::UpdateOrder, R"sql(
             update orders
             set customer = ?, product = ?, quantity = ?, status = ?, order_date = ?
             where id = ?
             )sql");
-  q.addBindValue(o.customer);
-  q.addBindValue(o.product);
-  q.addBindValue(o.quantity);
-  q.addBindValue(o.status);
-  q.addBindValue(o.orderDate.toString(Qt::ISODate));
-  q.addBindValue(orderId);
+  if (!q) {
+    return false;
+  }
+  StatementLease lease(*q);
+  bindOrder(*q, 0, o);
+  q->bindValue(5, orderId);
 
-  if (!q.exec()) {
-    lastErr = q.lastError().text();
+  QueryTrace trace(*q, connName);
+  if (!q->exec()) {
+    lastErr = q->lastError().text();
     return false;
   }
-  if (q.numRowsAffected() == 0) {
+  if (q->numRowsAffected() == 0) {
     lastErr = "Order not found.";
     return false;
   }
   return true;
 }
 
-std::optional<UserRow> Database::verifyUser(const QString &username,
-                                            const QString &password) {
+std::optional<long long> Database::updateOrders(const OrderSet &orders,
+                                                const OrderEdit &edit) {
+  TRACE_SCOPE("Database::updateOrders", "db");
+  lastErr.clear();
 
+  QStringList assignments;
+  QVariantList values;
+  if (edit.customer) {
+    assignments << "customer = ?";
+    values << edit.customer->trimmed();
+  }
+  if (edit.product) {
+    assignments << "product = ?";
+    values << edit.product->trimmed();
+  }
+  if (edit.quantity) {
+    assignments << "quantity = ?";
+    values << *edit.quantity;
+  }
+  if (edit.status) {
+    assignments << "status = ?";
+    values << static_cast<int>(*edit.status);
+  }
+  if (edit.orderDate) {
+    assignments << "order_date = ?";
+    values << edit.orderDate->toJulianDay();
+  }
+  if (assignments.isEmpty()) {
+    return 0;
+  }
+
+  return changeOrders(orders,
+                      "UPDATE orders SET " + assignments.join(", "), values);
+}
+
+std::optional<long long> Database::deleteOrders(const OrderSet &orders) {
+  TRACE_SCOPE("Database::deleteOrders", "db");
   lastErr.clear();
+  return changeOrders(orders, "DELETE FROM orders", {});
+}
 
-  QSqlQuery q;
-  q.prepare(R"SQL(
-            select id, username, password_salt, password_hash, role
-            from users
-            where username = ?
-            limit 1
-            )SQL");
-  q.addBindValue(username.trimmed());
+// Runs `statement` (an UPDATE or DELETE on orders, with `values` bound to
+// its placeholders) restricted to `orders`. Ids are staged in a temp table
+// first, so the change is a single statement with a join on the primary
+// key rather than one statement per id.
+std::optional<long long> Database::changeOrders(const OrderSet &orders,
+                                                const QString &statement,
+                                                const QVariantList &values) {
+  if (!orders.byFilter && orders.ids.empty()) {
+    return 0;
+  }
 
-  if (!q.exec()) {
-    lastErr = q.lastError().text();
+  auto db = connection();
+  if (!db.transaction()) {
+    lastErr = db.lastError().text();
     return std::nullopt;
   }
-  if (!q.next()) {
+
+  auto fail = [&](const QString &err) -> std::optional<long long> {
+    lastErr = err;
+    db.rollback();
     return std::nullopt;
+  };
+
+  QString sql = statement;
+  if (!orders.byFilter) {
+    if (!stageIds(orders.ids)) {
+      return fail(lastErr);
+    }
+    sql += " WHERE id IN (SELECT id FROM temp.bulk_ids)";
+  } else if (!orders.filter.isEmpty()) {
+    sql += " WHERE (" + orders.filter + ")";
   }
 
-  const QString salt = q.value(2).toString();
-  const QString storeHash = q.value(3).toString();
-  const QString inputHash = saltedSha256Hex(salt, password);
-  if (storeHash != inputHash) {
-    return std::nullopt;
+  QSqlQuery q(db);
+  if (!q.prepare(sql)) {
+    return fail(q.lastError().text());
+  }
+  for (const auto &value : values) {
+    q.addBindValue(value);
+  }
+
+  long long changed = 0;
+  {
+    QueryTrace trace(q, connName);
+    if (!q.exec()) {
+      return fail(q.lastError().text());
+    }
+    changed = q.numRowsAffected();
+  }
+
+  if (!orders.byFilter) {
+    QSqlQuery clear(db);
+    if (!clear.exec("DELETE FROM temp.bulk_ids")) {
+      return fail(clear.lastError().text());
+    }
+  }
+
+  if (!db.commit()) {
+    return fail(db.lastError().text());
+  }
+  return changed;
+}
+
+bool Database::stageIds(const std::vector<long long> &ids) {
+  QSqlQuery setup(connection());
+  if (!setup.exec("CREATE TEMP TABLE IF NOT EXISTS bulk_ids "
+                  "(id INTEGER PRIMARY KEY)") ||
+      !setup.exec("DELETE FROM temp.bulk_ids")) {
+    lastErr = setup.lastError().text();
+    return false;
+  }
+
+  std::size_t i = 0;
+  const auto n = ids.size();
+
+  if (n >= kStageBatchRows) {
+    static const QByteArray batchSql = stageIdsSql(kStageBatchRows);
+    auto *q = prepared(Statement::StageIdBatch, batchSql.constData());
+    if (!q) {
+      return false;
+    }
+    StatementLease lease(*q);
+
+    for (; i + kStageBatchRows <= n; i += kStageBatchRows) {
+      for (int r = 0; r < kStageBatchRows; ++r) {
+        q->bindValue(r, ids[i + r]);
+      }
+      QueryTrace trace(*q, connName);
+      if (!q->exec()) {
+        lastErr = q->lastError().text();
+        return false;
+      }
+    }
   }
 
+  if (i < n) {
+    QSqlQuery q(connection());
+    if (!q.prepare(QString::fromLatin1(
+            stageIdsSql(static_cast<int>(n - i))))) {
+      lastErr = q.lastError().text();
+      return false;
+    }
+    for (int r = 0; i < n; ++i, ++r) {
+      q.bindValue(r, ids[i]);
+    }
+    QueryTrace trace(q, connName);
+    if (!q.exec()) {
+      lastErr = q.lastError().text();
+      return false;
+    }
+  }
+  return true;
+}
+
+std::optional<UserRow> Database::verifyUser(const QString &username,
+                                            const QString &password) {
+  TRACE_SCOPE("Database::verifyUser", "db");
+  lastErr.clear();
+
+  // The statement is reset before hashing, so the KDF's run time is not
+  // spent inside a read transaction.
   UserRow r;
-  r.id = q.value(0).toLongLong();
-  r.username = q.value(1).toString();
-  r.role = q.value(4).toString();
+  PasswordHash stored;
+  const bool found = loadCredentials(username, r, stored);
+  if (!found && !lastErr.isEmpty()) {
+    return std::nullopt;
+  }
+  // An unknown username costs a derivation too, so the response time does
+  // not reveal which usernames exist.
+  if (!found) {
+    stored = dummyPasswordHash(passwordCost);
+  }
+  if (!verifyPassword(password, stored) || !found) {
+    return std::nullopt;
+  }
+
+  if (needsRehash(stored, passwordCost) &&
+      !storePasswordHash(r.id, hashPassword(password, passwordCost))) {
+    // The old hash still works; try again on the next sign-in.
+    qWarning().noquote() << "Failed to upgrade password hash for"
+                         << r.username << ":" << lastErr;
+    lastErr.clear();
+  }
   return r;
 };
 
+bool Database::loadCredentials(const QString &username, UserRow &user,
+                               PasswordHash &hash) {
+  lastErr.clear();
+  auto *q = prepared(Statement::VerifyUser, R"SQL(
+            select id, username, password_salt, password_hash, role,
+                   password_algo, password_cost
+            from users
+            where username = ?
+            limit 1
+            )SQL");
+  if (!q) {
+    return false;
+  }
+  StatementLease lease(*q);
+  q->bindValue(0, username.trimmed());
+
+  QueryTrace trace(*q, connName);
+  if (!q->exec()) {
+    lastErr = q->lastError().text();
+    return false;
+  }
+  if (!q->next()) {
+    return false;
+  }
+  trace.row();
+
+  user.id = q->value(0).toLongLong();
+  user.username = q->value(1).toString();
+  user.role = q->value(4).toString();
+  hash.saltHex = q->value(2).toString();
+  hash.hashHex = q->value(3).toString();
+  hash.algorithm = q->value(5).toString();
+  hash.cost = q->value(6).toInt();
+  return true;
+}
+
+bool Database::storePasswordHash(long long userId,
+                                 const PasswordHash &h) {
+  lastErr.clear();
+  auto *q = prepared(Statement::StorePasswordHash, R"SQL(
+            update users
+            set password_salt = ?, password_hash = ?, password_algo = ?,
+                password_cost = ?
+            where id = ?
+            )SQL");
+  if (!q) {
+    return false;
+  }
+  StatementLease lease(*q);
+  q->bindValue(0, h.saltHex);
+  q->bindValue(1, h.hashHex);
+  q->bindValue(2, h.algorithm);
+  q->bindValue(3, h.cost);
+  q->bindValue(4, userId);
+
+  QueryTrace trace(*q, connName);
+  if (!q->exec()) {
+    lastErr = q->lastError().text();
+    return false;
+  }
+  return true;
+}
+
 bool Database::hasAnyUsers() {
+  TRACE_SCOPE("Database::hasAnyUsers", "db");
   lastErr.clear();
 
-  QSqlQuery q;
+  QSqlQuery q(connection());
+  QueryTrace trace(q, connName);
   if (!q.exec("select 1 from users limit 1")) {
     lastErr = q.lastError().text();
     return false;
   }
-  return q.next();
+  if (!q.next()) {
+    return false;
+  }
+  trace.row();
+  return true;
 }
 
 std::optional<UserRow> Database::createUser(const QString &username,
                                             const QString &password,
                                             const QString &role) {
+  TRACE_SCOPE("Database::createUser", "db");
   lastErr.clear();
 
   const auto u = username.trimmed();
@@ -374,26 +1372,32 @@ std::optional<UserRow> Database::createUser(const QString &username,
     return std::nullopt;
   }
 
-  const QString salt = randomSaltHex();
-  const QString hash = saltedSha256Hex(salt, password);
+  const auto hash = hashPassword(password, passwordCost);
 
-  QSqlQuery q;
-  q.prepare(R"SQL(
-            insert into users (username, password_salt, password_hash, role)
-            values (?, ?, ?, ?)
+  auto *q = prepared(Statement::CreateUser, R"SQL(
+            insert into users (username, password_salt, password_hash, role,
+                               password_algo, password_cost)
+            values (?, ?, ?, ?, ?, ?)
             )SQL");
-  q.addBindValue(u);
-  q.addBindValue(salt);
-  q.addBindValue(hash);
-  q.addBindValue(role);
-
-  if (!q.exec()) {
-    lastErr = q.lastError().text();
+  if (!q) {
+    return std::nullopt;
+  }
+  StatementLease lease(*q);
+  q->bindValue(0, u);
+  q->bindValue(1, hash.saltHex);
+  q->bindValue(2, hash.hashHex);
+  q->bindValue(3, role);
+  q->bindValue(4, hash.algorithm);
+  q->bindValue(5, hash.cost);
+
+  QueryTrace trace(*q, connName);
+  if (!q->exec()) {
+    lastErr = q->lastError().text();
     return std::nullopt;
   }
 
   UserRow r;
-  r.id = q.lastInsertId().toLongLong();
+  r.id = q->lastInsertId().toLongLong();
   r.username = u;
   r.role = role;
   return r;
@@ -1,21 +1,122 @@
 #pragma once
 
 #include <QDate>
+#include <QSqlQuery>
 #include <QString>
+#include <QVariant>
+#include <atomic>
+#include <functional>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "models.h"
+#include "password_hash.h"
 
 struct OrderRow {
   long long id = 0;
   QString customer;
   QString product;
   int quantity = 0;
-  QString status;
+  OrderStatus status = OrderStatus::Pending;
   QDate orderDate;
 };
 
+// Filter and ordering for a window over the orders table.
+struct OrderQuery {
+  QString filter; // SQL WHERE fragment, empty for all rows
+  int sortColumn = 0;
+  Qt::SortOrder sortOrder = Qt::DescendingOrder;
+
+  bool operator==(const OrderQuery &) const = default;
+};
+
+// Keyset position: sort value and id of the last row already read.
+struct OrderCursor {
+  QVariant sortValue;
+  long long id = 0;
+};
+
+// An order touched by a mutation, so views can patch just that row.
+struct OrderChange {
+  enum class Kind { Inserted, Updated, Deleted };
+  Kind kind = Kind::Updated;
+  long long id = 0;
+};
+
+// Changes read back from orders_changelog, which triggers append to on
+// every insert, update and delete of an order, whichever process made it.
+struct ChangeFeed {
+  std::vector<OrderChange> changes; // oldest first
+  long long lastSeq = 0;            // changelog position read up to
+  // False when the log no longer reaches back to the requested position
+  // (pruned) or held more changes than asked for; re-read everything.
+  bool complete = true;
+};
+
+// The orders a bulk change applies to: a set of ids, or every order
+// matching a WHERE fragment (as in OrderQuery::filter; empty for all).
+struct OrderSet {
+  std::vector<long long> ids;
+  QString filter;
+  bool byFilter = false;
+
+  static OrderSet withIds(std::vector<long long> ids) {
+    return {std::move(ids), {}, false};
+  }
+  static OrderSet matching(const QString &filter) {
+    return {{}, filter, true};
+  }
+};
+
+// Fields a bulk edit sets; the rest keep each order's own values.
+struct OrderEdit {
+  std::optional<QString> customer;
+  std::optional<QString> product;
+  std::optional<int> quantity;
+  std::optional<OrderStatus> status;
+  std::optional<QDate> orderDate;
+};
+
+// Rows of the summary tables that triggers keep in step with orders.
+struct StatusCount {
+  OrderStatus status = OrderStatus::Pending;
+  long long orders = 0;
+};
+
+struct ProductDayTotal {
+  QString product;
+  QDate day;
+  long long orders = 0;
+  long long quantity = 0;
+};
+
+struct CustomerOrderCount {
+  QString customer;
+  long long orders = 0;
+};
+
+// A distinct customer or product and the number of orders that use it.
+struct ValueFrequency {
+  QString value;
+  long long orders = 0;
+};
+
+// Named sets of connection PRAGMAs, applied when a connection opens and
+// switchable while it is open (see ScopedProfile).
+enum class ConnectionProfile {
+  Interactive,       // WAL, synchronous=NORMAL: commits survive a crash,
+                     // the last few may be lost on power failure; the
+                     // default, with a moderate cache
+  BulkIngest,        // large cache, no fsync per commit; for imports
+  ReadOnlyReporting, // query_only, large cache and mmap; for long reads
+};
+
+// "interactive", "bulk-ingest" or "reporting".
+QString connectionProfileName(ConnectionProfile profile);
+std::optional<ConnectionProfile>
+connectionProfileFromName(const QString &name);
+
 struct UserRow {
   long long id;
   QString username;
@@ -24,28 +125,178 @@ struct UserRow {
 
 class Database final {
 public:
-  bool open();
+  // An empty name uses Qt's default connection. Each thread that talks to
+  // SQLite needs a Database with its own connection name. An empty path
+  // uses logistics.sqlite in the app data directory.
+  explicit Database(const QString &connectionName = {},
+                    const QString &path = {});
+
+  bool open(ConnectionProfile profile = ConnectionProfile::Interactive);
+  void close();
+  // Applies the profile's PRAGMAs to the open connection and logs the
+  // values SQLite reports back.
+  bool applyProfile(ConnectionProfile profile);
+  ConnectionProfile profile() const { return activeProfile; }
   bool migrate();
+  // Read transaction: every read until endRead() sees the same commit.
+  // Not for writes, which open transactions of their own.
+  bool beginRead();
+  void endRead();
+  // Makes the statement running on this connection fail with "interrupted".
+  // Safe to call from any thread. Needs a build with
+  // LOGISTICS_SQLITE_INTERRUPT; otherwise it does nothing.
+  void interrupt();
 
   // order
   std::optional<long long> insertOrder(const OrderDraft &order);
+  // Inserts all orders in one transaction using multi-row statements.
+  bool insertOrders(const std::vector<OrderDraft> &orders);
   std::vector<OrderRow> listOrders();
+  std::optional<long long> countOrders(const OrderQuery &query);
+  std::vector<OrderRow> listOrdersPage(const OrderQuery &query,
+                                       const std::optional<OrderCursor> &after,
+                                       long long skip, int limit);
+  // The orders among `ids` that match `query`'s filter, in no particular
+  // order; ids that are gone or filtered out are left out.
+  std::vector<OrderRow> matchingOrders(const OrderQuery &query,
+                                       const std::vector<long long> &ids);
+  // Streams matching orders to `visit` in query order without holding the
+  // result set; stops early when `visit` returns false.
+  bool forEachOrder(const OrderQuery &query,
+                    const std::function<bool(const OrderRow &)> &visit);
   std::optional<OrderRow> getOrder(long long orderId);
   bool updateOrder(long long orderId, const OrderDraft &order);
   bool deleteOrder(long long orderId);
+  // Bulk changes run as one statement in one transaction however many
+  // orders they touch. They return the number of orders changed.
+  std::optional<long long> updateOrders(const OrderSet &orders,
+                                        const OrderEdit &edit);
+  std::optional<long long> deleteOrders(const OrderSet &orders);
+
+  // summaries: read from trigger-maintained tables, not from orders, so
+  // the cost does not grow with the number of orders.
+  std::vector<StatusCount> orderStatusCounts();
+  // Products ordered on `day`, by quantity, largest first.
+  std::vector<ProductDayTotal> productTotalsForDay(const QDate &day,
+                                                   int limit);
+  // Customers with the most orders, most first.
+  std::vector<CustomerOrderCount> topCustomers(int limit);
+  // Every distinct customer / product with its order count, for
+  // autocompletion.
+  std::vector<ValueFrequency> customerFrequencies();
+  std::vector<ValueFrequency> productFrequencies();
+
+  // changelog
+  // Changes after changelog position `since`, at most `limit` of them.
+  std::optional<ChangeFeed> changesSince(long long since, int limit);
+  // Position of the newest change, 0 when there is none.
+  std::optional<long long> latestChange();
+  // Drops up to `limit` of the oldest changelog entries, never one of the
+  // newest `keep`; returns how many it dropped.
+  std::optional<long long> pruneChangelog(long long keep, long long limit);
+  // Changes whenever another connection, in this process or another one,
+  // commits to the database.
+  std::optional<long long> dataVersion();
 
   // user
   bool hasAnyUsers();
   std::optional<UserRow> createUser(const QString &username,
                                     const QString &password,
                                     const QString &role);
+  // Upgrades the stored hash to the current algorithm and cost when the
+  // password matches.
   std::optional<UserRow> verifyUser(const QString &username,
                                     const QString &password);
+  // PBKDF2 iterations for hashes written from now on.
+  void setPasswordCost(int cost) { passwordCost = cost; }
+  int currentPasswordCost() const { return passwordCost; }
+  // The two halves of verifyUser around the key derivation, for callers
+  // that derive on another thread. loadCredentials returns false with an
+  // empty lastError() when the username does not exist.
+  bool loadCredentials(const QString &username, UserRow &user,
+                       PasswordHash &hash);
+  bool storePasswordHash(long long userId, const PasswordHash &hash);
 
   // error
   QString lastError() const { return lastErr; }
 
+  // Prepared statements are compiled once per connection and reused.
+  struct StatementCacheStats {
+    quint64 hits = 0;
+    quint64 misses = 0;
+  };
+  StatementCacheStats statementCacheStats() const { return statementStats; }
+
 private:
+  friend class ScopedProfile;
+
+  enum class Statement {
+    InsertOrder,
+    InsertOrderBatch,
+    GetOrder,
+    UpdateOrder,
+    DeleteOrder,
+    VerifyUser,
+    CreateUser,
+    StorePasswordHash,
+    StageIdBatch,
+  };
+
+  QString connName;
+  QString filePath;
   QString lastErr;
+  ConnectionProfile activeProfile = ConnectionProfile::Interactive;
+  int passwordCost = kDefaultPasswordCost;
+  std::atomic<void *> sqliteHandle = nullptr; // sqlite3 *, for interrupt()
+  std::unordered_map<Statement, QSqlQuery> statements;
+  StatementCacheStats statementStats;
+
+  QSqlQuery *prepared(Statement id, const char *sql);
+  std::optional<long long> changeOrders(const OrderSet &orders,
+                                        const QString &statement,
+                                        const QVariantList &values);
+  bool stageIds(const std::vector<long long> &ids);
   QString dbPath() const;
+  QSqlDatabase connection() const;
+};
+
+// Switches a Database to another profile for the guard's lifetime, then
+// restores the one it had before. A failed switch is logged and leaves
+// the connection usable; false means the profile is not in effect.
+// Restoring keeps lastError() from the work done under the guard.
+class ScopedProfile final {
+public:
+  ScopedProfile(Database &db, ConnectionProfile profile);
+  ~ScopedProfile();
+
+  ScopedProfile(const ScopedProfile &) = delete;
+  ScopedProfile &operator=(const ScopedProfile &) = delete;
+
+  explicit operator bool() const { return applied; }
+
+private:
+  Database &db;
+  ConnectionProfile previous;
+  bool switched = false;
+  bool applied = true;
+};
+
+// Keeps the reads made during its lifetime in one read transaction.
+class ReadSnapshot final {
+public:
+  explicit ReadSnapshot(Database &db) : db(db), open(db.beginRead()) {}
+  ~ReadSnapshot() {
+    if (open) {
+      db.endRead();
+    }
+  }
+
+  ReadSnapshot(const ReadSnapshot &) = delete;
+  ReadSnapshot &operator=(const ReadSnapshot &) = delete;
+
+  explicit operator bool() const { return open; }
+
+private:
+  Database &db;
+  bool open;
 };
@@ -35,6 +35,6 @@ void DetailScreen::setOrder(const OrderRow &order) {
   customerValue->setText(order.customer);
   productValue->setText(order.product);
   quantityValue->setText(QString::number(order.quantity));
-  statusValue->setText(order.status);
+  statusValue->setText(orderStatusName(order.status));
   dateValue->setText(order.orderDate.toString(Qt::ISODate));
 }
@@ -4,24 +4,51 @@
 #include <QHeaderView>
 #include <QMenu>
 #include <QMessageBox>
+#include <QPaintEvent>
 #include <QTimer>
 #include <QVBoxLayout>
+#include <algorithm>
+
+#include "models.h"
+#include "order_filter.h"
+#include "trace.h"
+
+namespace {
+// Times each repaint of the orders table for the trace.
+class TracedTableView final : public QTableView {
+public:
+  using QTableView::QTableView;
+
+protected:
+  void paintEvent(QPaintEvent *event) override {
+    TRACE_SCOPE("QTableView::paintEvent", "ui");
+    QTableView::paintEvent(event);
+  }
+};
+} // namespace
 
 HomeScreen::HomeScreen(QWidget *parent) : QWidget(parent) {
   createOrderBtn = new QPushButton("Create Order", this);
+  importOrdersBtn = new QPushButton("Import Orders...", this);
+  exportOrdersBtn = new QPushButton("Export Orders...", this);
+  exportOrdersBtn->setToolTip("Export the orders matching the current search");
 
   searchEdit = new QLineEdit(this);
   statusCombo = new QComboBox(this);
-  statusCombo->addItems(
-      {"All", "pending", "processing", "shipped", "delivered", "cancelled"});
+  statusCombo->addItem("All");
+  for (qsizetype i = 0; i < orderStatuses().size(); ++i) {
+    statusCombo->addItem(orderStatuses().at(i), static_cast<int>(i));
+  }
   searchEdit->setPlaceholderText("Search orders...");
 
-  table = new QTableView(this);
+  table = new TracedTableView(this);
   table->setSelectionBehavior(QAbstractItemView::SelectRows);
-  table->setSelectionMode(QAbstractItemView::SingleSelection);
+  table->setSelectionMode(QAbstractItemView::ExtendedSelection);
   table->setSortingEnabled(true);
   table->setContextMenuPolicy(Qt::CustomContextMenu);
   table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  // Fixed row heights keep the header from measuring millions of sections.
+  table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
 
   auto *deleteAction = new QAction(table);
   deleteAction->setShortcut(QKeySequence::Delete);
@@ -41,18 +68,31 @@ HomeScreen::HomeScreen(QWidget *parent) : QWidget(parent) {
   header->setStretchLastSection(true);
   header->setSectionResizeMode(QHeaderView::Stretch);
 
+  auto *actions = new QHBoxLayout();
+  actions->addWidget(createOrderBtn);
+  actions->addWidget(importOrdersBtn);
+  actions->addWidget(exportOrdersBtn);
+
   auto *filters = new QHBoxLayout();
   filters->addWidget(searchEdit);
   filters->addWidget(statusCombo);
 
   auto *layout = new QVBoxLayout(this);
-  layout->addWidget(createOrderBtn);
+  layout->addLayout(actions);
   layout->addLayout(filters);
   layout->addWidget(table);
 
-  connect(searchEdit, &QLineEdit::textChanged, this,
-          [this] { searchDebounce->start(); });
-  connect(searchDebounce, &QTimer::timeout, this, [this] { applyFilter(); });
+  connect(searchEdit, &QLineEdit::textChanged, this, [this] {
+    Tracer::instant("searchEdit keystroke", "ui");
+    if (!searchDebounce->isActive()) {
+      Tracer::asyncBegin("search debounce", "debounce", ++debounceSpan);
+    }
+    searchDebounce->start();
+  });
+  connect(searchDebounce, &QTimer::timeout, this, [this] {
+    Tracer::asyncEnd("search debounce", "debounce", debounceSpan);
+    applyFilter();
+  });
   connect(statusCombo, &QComboBox::currentTextChanged, this,
           [this] { applyFilter(); });
 
@@ -62,11 +102,17 @@ HomeScreen::HomeScreen(QWidget *parent) : QWidget(parent) {
               return;
             }
             model->setSort(column, order);
-            model->select();
+            if (!model->isCurrent()) {
+              model->select();
+            }
           });
 
   connect(createOrderBtn, &QPushButton::clicked, this,
           [this] { emit createOrderRequested(); });
+  connect(importOrdersBtn, &QPushButton::clicked, this,
+          [this] { emit importOrdersRequested(); });
+  connect(exportOrdersBtn, &QPushButton::clicked, this,
+          [this] { emit exportOrdersRequested(); });
 
   connect(table, &QTableView::customContextMenuRequested, this,
           [this](const QPoint &pos) { handleOpenContextMenu(pos); });
@@ -79,39 +125,29 @@ HomeScreen::HomeScreen(QWidget *parent) : QWidget(parent) {
 }
 
 void HomeScreen::applyFilter() {
+  TRACE_SCOPE("HomeScreen::applyFilter", "ui");
   if (!model) {
     return;
   }
 
-  const auto term = searchEdit->text().trimmed();
-  const auto status = statusCombo->currentText();
-
-  QStringList parts;
-
-  if (!term.isEmpty()) {
-    const auto t = escapeSqlString(term);
-    parts << QString("(customer LIKE '%%1%' OR product LIKE '%%1%' OR status "
-                     "LIKE '%%1%')")
-                 .arg(t);
+  // "All" carries no status value.
+  std::optional<OrderStatus> status;
+  if (const auto data = statusCombo->currentData(); data.isValid()) {
+    status = static_cast<OrderStatus>(data.toInt());
   }
-
-  if (status != "All") {
-    parts << QString("status = '%1'").arg(escapeSqlString(status));
+  model->setFilter(orderSearchFilter(searchEdit->text(), status));
+  if (!model->isCurrent()) {
+    model->select();
   }
-
-  model->setFilter(parts.join(" AND "));
-  model->select();
 }
 
-void HomeScreen::setOrdersModel(QSqlTableModel *m) {
+void HomeScreen::setOrdersModel(OrdersTableModel *m) {
   model = m;
   table->setModel(model);
-  table->setColumnHidden(0, true);
+  table->setColumnHidden(OrdersTableModel::IdColumn, true);
   applyFilter();
 }
 
-QString HomeScreen::escapeSqlString(QString s) { return s.replace("'", "''"); }
-
 void HomeScreen::handleOpenContextMenu(const QPoint &pos) {
   if (!model) {
     return;
@@ -121,25 +157,42 @@ void HomeScreen::handleOpenContextMenu(const QPoint &pos) {
   if (!idx.isValid()) {
     return;
   }
-  table->selectionModel()->select(idx, QItemSelectionModel::ClearAndSelect |
-                                           QItemSelectionModel::Rows);
+  // Right-clicking inside a multi-row selection acts on all of it.
+  auto *selection = table->selectionModel();
+  if (!selection->isRowSelected(idx.row(), {})) {
+    selection->setCurrentIndex(idx, QItemSelectionModel::ClearAndSelect |
+                                        QItemSelectionModel::Rows);
+  }
 
-  const int row = idx.row();
-  const long long orderId = model->data(model->index(row, 0)).toLongLong();
+  long long selected = 0;
+  selectedRanges(selected);
 
   QMenu menu(this);
-  QAction *viewDetailAction = menu.addAction("View Order Details");
-  QAction *editOrderAction = menu.addAction("Edit Order");
-  QAction *deleteAction = menu.addAction("Delete Order");
+  QAction *viewDetailAction = nullptr;
+  QAction *editOrderAction = nullptr;
+  if (selected == 1) {
+    viewDetailAction = menu.addAction("View Order Details");
+    editOrderAction = menu.addAction("Edit Order");
+  }
+  QMenu *statusMenu = menu.addMenu("Set Status");
+  for (qsizetype i = 0; i < orderStatuses().size(); ++i) {
+    const auto status = static_cast<OrderStatus>(i);
+    statusMenu->addAction(orderStatuses().at(i), this,
+                          [this, status] { handleSetStatus(status); });
+  }
+  QAction *deleteAction = menu.addAction(
+      selected == 1 ? QString("Delete Order")
+                    : QString("Delete %1 Orders").arg(selected));
   QAction *chosen = menu.exec(table->viewport()->mapToGlobal(pos));
 
   if (chosen == deleteAction) {
     handleDeleteOrder();
   }
-  if (chosen == viewDetailAction) {
-    emit detailsRequested(orderId);
+  if (chosen && chosen == viewDetailAction) {
+    withOrderAt(idx.row(),
+                [this](long long orderId) { emit detailsRequested(orderId); });
   }
-  if (chosen == editOrderAction) {
+  if (chosen && chosen == editOrderAction) {
     handleEditOrder();
   }
 }
@@ -149,6 +202,19 @@ void HomeScreen::handleDeleteOrder() {
     return;
   }
 
+  long long selected = 0;
+  selectedRanges(selected);
+  if (selected > 1) {
+    const auto res = QMessageBox::question(
+        this, "Delete orders", QString("Delete %1 orders?").arg(selected),
+        QMessageBox::Yes | QMessageBox::No);
+    if (res == QMessageBox::Yes) {
+      withSelectedOrders(
+          [this](OrderSet orders) { emit bulkDeleteRequested(orders); });
+    }
+    return;
+  }
+
   const auto idx = table->selectionModel()->currentIndex();
   if (!idx.isValid()) {
     QMessageBox::information(this, "Select order",
@@ -163,15 +229,14 @@ void HomeScreen::handleDeleteOrder() {
     return;
   }
 
-  const auto orderId = model->data(model->index(row, 0)).toLongLong();
-  const auto res = QMessageBox::question(
-      this, "Delete order", QString("Delete order #%1?").arg(orderId),
-      QMessageBox::Yes | QMessageBox::No);
-  if (res != QMessageBox::Yes) {
-    return;
-  }
-
-  emit deleteOrderRequested(orderId);
+  withOrderAt(row, [this](long long orderId) {
+    const auto res = QMessageBox::question(
+        this, "Delete order", QString("Delete order #%1?").arg(orderId),
+        QMessageBox::Yes | QMessageBox::No);
+    if (res == QMessageBox::Yes) {
+      emit deleteOrderRequested(orderId);
+    }
+  });
 }
 
 void HomeScreen::handleEditOrder() {
@@ -185,7 +250,81 @@ void HomeScreen::handleEditOrder() {
     return;
   }
 
-  const auto row = idx.row();
-  const auto orderId = model->data(model->index(row, 0)).toLongLong();
-  emit editOrderRequested(orderId);
+  withOrderAt(idx.row(),
+              [this](long long orderId) { emit editOrderRequested(orderId); });
+}
+
+void HomeScreen::handleSetStatus(OrderStatus status) {
+  if (!model) {
+    return;
+  }
+  withSelectedOrders([this, status](OrderSet orders) {
+    emit bulkStatusRequested(orders, status);
+  });
+}
+
+std::vector<OrdersTableModel::RowRange>
+HomeScreen::selectedRanges(long long &rows) const {
+  std::vector<OrdersTableModel::RowRange> ranges;
+  for (const auto &range : table->selectionModel()->selection()) {
+    ranges.push_back({range.top(), range.bottom()});
+  }
+  std::sort(ranges.begin(), ranges.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  // Ranges from separate clicks may overlap or touch.
+  std::vector<OrdersTableModel::RowRange> merged;
+  for (const auto &r : ranges) {
+    if (!merged.empty() && r.first <= merged.back().last + 1) {
+      merged.back().last = std::max(merged.back().last, r.last);
+    } else {
+      merged.push_back(r);
+    }
+  }
+
+  rows = 0;
+  for (const auto &r : merged) {
+    rows += r.last - r.first + 1;
+  }
+  return merged;
+}
+
+void HomeScreen::withSelectedOrders(std::function<void(OrderSet)> use) {
+  long long rows = 0;
+  const auto ranges = selectedRanges(rows);
+  if (rows == 0) {
+    QMessageBox::information(this, "Select orders", "Select orders first.");
+    return;
+  }
+
+  // Select All on a large result: one statement over the filter instead
+  // of looking up every id.
+  if (rows == model->rowCount()) {
+    use(OrderSet::matching(model->currentQuery().filter));
+    return;
+  }
+
+  model->orderIds(ranges).then(
+      this, [this, use](DbResult<std::vector<long long>> r) {
+        if (!r.error.isEmpty()) {
+          QMessageBox::critical(this, "Database error", r.error);
+          return;
+        }
+        use(OrderSet::withIds(std::move(r.value)));
+      });
+}
+
+void HomeScreen::withOrderAt(int row, std::function<void(long long)> use) {
+  model->orderIds({{row, row}})
+      .then(this, [this, use](DbResult<std::vector<long long>> r) {
+        if (!r.error.isEmpty()) {
+          QMessageBox::critical(this, "Database error", r.error);
+          return;
+        }
+        // The row was removed before its id could be read.
+        if (r.value.empty()) {
+          return;
+        }
+        use(r.value.front());
+      });
 }
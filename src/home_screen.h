@@ -3,9 +3,14 @@
 #include <QComboBox>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QSqlTableModel>
 #include <QTableView>
 #include <QWidget>
+#include <functional>
+#include <vector>
+
+#include "database.h"
+#include "models.h"
+#include "orders_table_model.h"
 
 class QTimer;
 
@@ -15,28 +20,45 @@ class HomeScreen final : public QWidget {
 public:
   explicit HomeScreen(QWidget *parent = nullptr);
 
-  void setOrdersModel(QSqlTableModel *model);
+  void setOrdersModel(OrdersTableModel *model);
 
 signals:
   void createOrderRequested();
+  void importOrdersRequested();
+  void exportOrdersRequested();
   void deleteOrderRequested(long long orderId);
   void detailsRequested(long long orderId);
   void editOrderRequested(long long orderId);
+  // Several orders at once; confirmed with the user where needed.
+  void bulkStatusRequested(const OrderSet &orders, OrderStatus status);
+  void bulkDeleteRequested(const OrderSet &orders);
 
 private:
   QPushButton *createOrderBtn;
+  QPushButton *importOrdersBtn;
+  QPushButton *exportOrdersBtn;
 
   QLineEdit *searchEdit;
   QComboBox *statusCombo;
 
   QTableView *table;
-  QSqlTableModel *model = nullptr;
+  OrdersTableModel *model = nullptr;
 
   QTimer *searchDebounce;
+  quint64 debounceSpan = 0; // trace id of the pending debounce wait
 
   void applyFilter();
   void handleOpenContextMenu(const QPoint &pos);
   void handleDeleteOrder();
   void handleEditOrder();
-  static QString escapeSqlString(QString s);
+  void handleSetStatus(OrderStatus status);
+
+  // Selected rows merged into sorted runs, and the number of rows in them.
+  std::vector<OrdersTableModel::RowRange> selectedRanges(long long &rows) const;
+  // Passes the selection to `use`: as the current filter when every row is
+  // selected, otherwise as ids resolved through the model.
+  void withSelectedOrders(std::function<void(OrderSet)> use);
+  // Passes the id of the order at `row` to `use`, reading it first when
+  // the row's page is not loaded yet.
+  void withOrderAt(int row, std::function<void(long long)> use);
 };
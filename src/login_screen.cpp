@@ -1,10 +1,9 @@
 #include "login_screen.h"
-#include "database.h"
 #include <QGridLayout>
 #include <QLabel>
 #include <QMessageBox>
 
-LoginScreen::LoginScreen(Database *db_, QWidget *parent)
+LoginScreen::LoginScreen(AsyncDatabase *db_, QWidget *parent)
     : QWidget(parent), db(db_) {
   titleLabel = new QLabel("Admin sign in", this);
   titleLabel->setStyleSheet("font-size: 18px; font-weight: 600;");
@@ -70,9 +69,16 @@ LoginScreen::LoginScreen(Database *db_, QWidget *parent)
 
 void LoginScreen::refresh() {
   setError({});
+  if (!db) {
+    setCreateAdminMode(true);
+    return;
+  }
 
-  const bool anyUsers = db && db->hasAnyUsers();
-  setCreateAdminMode(!anyUsers);
+  setBusy(true);
+  db->hasAnyUsers().then(this, [this](DbResult<bool> r) {
+    setBusy(false);
+    setCreateAdminMode(!r.value);
+  });
 }
 
 void LoginScreen::setCreateAdminMode(bool enabled) {
@@ -91,12 +97,34 @@ void LoginScreen::setCreateAdminMode(bool enabled) {
   }
 }
 
+void LoginScreen::setBusy(bool on) {
+  busy = on;
+  usernameEdit->setEnabled(!on);
+  passwordEdit->setEnabled(!on);
+  confirmEdit->setEnabled(!on);
+  primaryBtn->setEnabled(!on);
+}
+
+void LoginScreen::finishSignIn(const DbResult<std::optional<UserRow>> &result,
+                               const QString &fallbackError) {
+  setBusy(false);
+  if (!result.value) {
+    setError(result.error.isEmpty() ? fallbackError : result.error);
+    passwordEdit->setFocus();
+    return;
+  }
+  emit authenticated(result.value->id, result.value->username);
+}
+
 void LoginScreen::setError(const QString &msg) {
   errorLabel->setText(msg);
   errorLabel->setVisible(!msg.isEmpty());
 }
 
 void LoginScreen::attemptPrimary() {
+  if (busy) {
+    return;
+  }
   setError({});
 
   if (!db) {
@@ -127,21 +155,17 @@ void LoginScreen::attemptPrimary() {
       return;
     }
 
-    const auto created = db->createUser(username, password, "admin");
-    if (!created) {
-      setError(db->lastError().isEmpty() ? "Failed to create user."
-                                         : db->lastError());
-      return;
-    }
-    emit authenticated(created->id, created->username);
+    setBusy(true);
+    db->createUser(username, password, "admin")
+        .then(this, [this](DbResult<std::optional<UserRow>> r) {
+          finishSignIn(r, "Failed to create user.");
+        });
     return;
   } else {
-    const auto user = db->verifyUser(username, password);
-    if (!user) {
-      setError(db->lastError().isEmpty() ? "Invalid username or password"
-                                         : db->lastError());
-      return;
-    }
-    emit authenticated(user->id, user->username);
+    setBusy(true);
+    db->verifyUser(username, password)
+        .then(this, [this](DbResult<std::optional<UserRow>> r) {
+          finishSignIn(r, "Invalid username or password");
+        });
   }
 }
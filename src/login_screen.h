@@ -3,7 +3,7 @@
 #include "QLineEdit"
 #include "QPushButton"
 #include "QWidget"
-#include "database.h"
+#include "async_database.h"
 #include <QLabel>
 #include <QCheckBox>
 
@@ -11,14 +11,14 @@ class LoginScreen final : public QWidget {
   Q_OBJECT
 
 public:
-  explicit LoginScreen(Database *db, QWidget *parent = nullptr);
+  explicit LoginScreen(AsyncDatabase *db, QWidget *parent = nullptr);
   void refresh();
 
 signals:
   void authenticated(long long userId, const QString &username);
 
 private:
-  Database *db;
+  AsyncDatabase *db;
 
   QLabel *titleLabel;
   QLabel *hintLabel;
@@ -31,8 +31,13 @@ private:
   QPushButton *primaryBtn;
 
   bool createAdminMode = false;
+  bool busy = false;
 
   void setCreateAdminMode(bool enabled);
+  // Locks the form while a request runs on the database thread.
+  void setBusy(bool on);
+  void finishSignIn(const DbResult<std::optional<UserRow>> &result,
+                    const QString &fallbackError);
   void attemptPrimary();
   void setError(const QString &msg);
 };
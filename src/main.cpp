@@ -1,12 +1,108 @@
 #include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QTimer>
 
+#include "database.h"
 #include "main_window.h"
+#include "password_hash.h"
+#include "query_log.h"
+#include "trace.h"
 
 int main(int argc, char *argv[]) {
+  QElapsedTimer startup;
+  startup.start();
   QApplication app(argc, argv);
 
-  MainWindow mainWindow;
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  const QCommandLineOption profileOption(
+      "db-profile",
+      "SQLite connection profile: interactive, bulk-ingest or reporting.",
+      "profile", connectionProfileName(ConnectionProfile::Interactive));
+  parser.addOption(profileOption);
+  const QCommandLineOption slowQueryOption(
+      "slow-query-ms",
+      "Log queries at or over this many milliseconds, with their plan.",
+      "ms", "100");
+  parser.addOption(slowQueryOption);
+  const QCommandLineOption logAllOption(
+      "log-all-queries", "Log every query's timing, not just slow ones.");
+  parser.addOption(logAllOption);
+  const QCommandLineOption traceOption(
+      "trace", "Record a Chrome trace (Perfetto) to this file on exit.",
+      "file");
+  parser.addOption(traceOption);
+  const QCommandLineOption passwordCostOption(
+      "password-cost",
+      "PBKDF2 iterations for password hashes; existing hashes are "
+      "upgraded at their next sign-in.",
+      "iterations", QString::number(kDefaultPasswordCost));
+  parser.addOption(passwordCostOption);
+  const QCommandLineOption readersOption(
+      "db-readers",
+      "Read-only connections for the orders list, exports and dashboard.",
+      "count", QString::number(MainWindow::kDefaultReaders));
+  parser.addOption(readersOption);
+  parser.process(app);
+
+  QueryLog::Settings logSettings;
+  logSettings.path =
+      QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation))
+          .filePath("query_log.jsonl");
+  logSettings.slowMs = parser.value(slowQueryOption).toDouble();
+  logSettings.logAll = parser.isSet(logAllOption);
+  QueryLog::instance().configure(logSettings);
+
+  const auto profile =
+      connectionProfileFromName(parser.value(profileOption));
+  if (!profile) {
+    qCritical().noquote() << "Unknown --db-profile:"
+                          << parser.value(profileOption);
+    return 2;
+  }
+
+  bool costOk = false;
+  const auto passwordCost = parser.value(passwordCostOption).toInt(&costOk);
+  if (!costOk || passwordCost < 1) {
+    qCritical().noquote() << "Invalid --password-cost:"
+                          << parser.value(passwordCostOption);
+    return 2;
+  }
+
+  bool readersOk = false;
+  const auto readers = parser.value(readersOption).toInt(&readersOk);
+  if (!readersOk || readers < 1) {
+    qCritical().noquote() << "Invalid --db-readers:"
+                          << parser.value(readersOption);
+    return 2;
+  }
+
+  const bool tracing = parser.isSet(traceOption);
+  if (tracing) {
+    Tracer::start();
+  }
+
+  MainWindow mainWindow(*profile, passwordCost, readers);
   mainWindow.show();
+  // Runs once the event loop has handled the show and first paint events.
+  QTimer::singleShot(0, &mainWindow, [&startup] {
+    qInfo().noquote() << "Startup:" << startup.elapsed()
+                      << "ms from main to first window";
+    Tracer::instant("first window shown", "app");
+  });
+
+  const int status = app.exec();
 
-  return app.exec();
+  if (tracing) {
+    QString err;
+    if (!Tracer::stop(parser.value(traceOption), err)) {
+      qWarning().noquote() << "Failed to write trace:" << err;
+    }
+  }
+  return status;
 }
@@ -1,7 +1,11 @@
 #include "main_window.h"
 
+#include <QDebug>
 #include <QDialog>
+#include <QFileDialog>
+#include <QFutureWatcher>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QSize>
 #include <QSizePolicy>
 #include <QSplitter>
@@ -10,13 +14,63 @@
 #include <QToolButton>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <QtConcurrent>
 #include <optional>
 #include <vector>
 
 #include "login_screen.h"
+#include "order_export.h"
+#include "order_filter.h"
 #include "order_form_dialog.h"
+#include "order_import.h"
+#include "trace.h"
+
+namespace {
+// Switches the writer to `profile`; resolves with the one it had before.
+QFuture<DbResult<ConnectionProfile>> switchProfile(ConnectionPool &pool,
+                                                   ConnectionProfile profile) {
+  return pool.write([profile](Database &d) {
+    const auto previous = d.profile();
+    if (!d.applyProfile(profile)) {
+      qWarning().noquote() << "Failed to switch the writer to profile"
+                           << connectionProfileName(profile) + ":"
+                           << d.lastError();
+    }
+    return previous;
+  });
+}
+
+// Runs on a worker thread of its own. Each batch is a separate job on the
+// writer, so edits made during a long import wait for one batch, not the
+// whole file. The writer stays on the bulk-ingest profile from the first
+// batch to the last, keeping its page cache; edits in between run under
+// it too.
+ImportReport importThroughWriter(QPromise<ImportReport> &promise,
+                                 ConnectionPool &pool, const QString &path,
+                                 ImportFormat format) {
+  const auto previous =
+      switchProfile(pool, ConnectionProfile::BulkIngest).result().value;
+
+  const ImportSink toWriter = [&](std::vector<OrderDraft> batch) {
+    if (promise.isCanceled()) {
+      return QString("Import canceled.");
+    }
+    auto written = pool.write([batch = std::move(batch)](Database &d) {
+      return d.insertOrders(batch);
+    });
+    const auto r = written.result();
+    return r.value ? QString() : r.error;
+  };
+  auto report = importOrders(path, format, toWriter);
+
+  switchProfile(pool, previous).waitForFinished();
+  return report;
+}
+} // namespace
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
+MainWindow::MainWindow(ConnectionProfile profile, int passwordCost,
+                       int readers, QWidget *parent)
+    : QMainWindow(parent), pool("orders", readers) {
   setWindowTitle("LogisticsApp");
   constexpr int kSidebarCollapsedWidth = 56;
 
@@ -57,13 +111,17 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 
   auto *ordersBtn = new QToolButton(sidebar);
   initMenuButton(ordersBtn, "Orders", QStyle::SP_FileDialogListView, false);
+  auto *dashboardBtn = new QToolButton(sidebar);
+  initMenuButton(dashboardBtn, "Dashboard", QStyle::SP_FileDialogInfoView,
+                 false);
   // auto *backBtn = new QToolButton(sidebar);
   // initMenuButton(backBtn, "Back", QStyle::SP_ArrowBack, false);
 
-  const std::vector<QToolButton *> menuButtons = {ordersBtn};
+  const std::vector<QToolButton *> menuButtons = {ordersBtn, dashboardBtn};
 
   sidebarLayout->addWidget(toggleBtn);
   sidebarLayout->addWidget(ordersBtn);
+  sidebarLayout->addWidget(dashboardBtn);
   sidebarLayout->addStretch(1);
   sidebar->setVisible(false);
   // sidebarLayout->addWidget(backBtn);
@@ -74,24 +132,37 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     return;
   }
 
+  pool.open(profile).then(this, [this](DbResult<bool> r) {
+    if (!r.value) {
+      QMessageBox::critical(this, "Database error", r.error);
+    }
+  });
+  pool.writer().setPasswordCost(passwordCost);
+  searchDb.open(profile);
+
+  auto *changePoll = new QTimer(this);
+  changePoll->setInterval(kChangePollMs);
+  connect(changePoll, &QTimer::timeout, this,
+          [this] { pollExternalChanges(); });
+  changePoll->start();
+
   // NOTE: Main content (right)
   stack = new QStackedWidget(rootSplitter);
-  login = new LoginScreen(&db, stack);
-  home = new HomeScreen(stack);
-  detail = new DetailScreen(stack);
-  ordersModel = nullptr;
-
+  // Sign-in may rehash the stored password, so it needs the writer.
+  login = new LoginScreen(&pool.writer(), stack);
   stack->addWidget(login);
-  stack->addWidget(home);
-  stack->addWidget(detail);
   stack->setCurrentWidget(login);
 
-  connect(login, &LoginScreen::authenticated, this, [this, ordersBtn, sidebar] {
+  connect(login, &LoginScreen::authenticated, this,
+          [this, ordersBtn, dashboardBtn, sidebar] {
     isAuthenticated = true;
     ordersBtn->setEnabled(true);
+    dashboardBtn->setEnabled(true);
     history.clear();
     sidebar->setVisible(true);
-    stack->setCurrentWidget(home);
+    stack->setCurrentWidget(homeScreen());
+    // After sign-in, which needs the writer, rather than ahead of it.
+    pruneChangelog();
   });
 
   connect(ordersBtn, &QToolButton::clicked, this, [this] {
@@ -99,7 +170,17 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
       return;
     }
     history.clear();
-    stack->setCurrentWidget(home);
+    stack->setCurrentWidget(homeScreen());
+  });
+
+  connect(dashboardBtn, &QToolButton::clicked, this, [this] {
+    if (!isAuthenticated) {
+      return;
+    }
+    history.clear();
+    auto *dashboard = dashboardScreen();
+    stack->setCurrentWidget(dashboard);
+    dashboard->reload();
   });
 
   rootSplitter->addWidget(sidebar);
@@ -181,46 +262,177 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   QTimer::singleShot(0, this,
                      [applySidebarExpanded] { applySidebarExpanded(true); });
 
-  // Sidebar actions
-  connect(ordersBtn, &QToolButton::clicked, this, [this] {
-    history.clear();
-    stack->setCurrentWidget(home);
-  });
-
   // connect(backBtn, &QToolButton::clicked, this, [this] { back(); });
 
   // Sync Back button enable state
   // connect(stack, &QStackedWidget::currentChanged, this,
   //         [this, backBtn] { backBtn->setEnabled(!history.empty()); });
 
-  // Home button events
+  // Once the login window is up, read the first orders page on a separate
+  // connection while the user types, so Orders opens without waiting.
+  QTimer::singleShot(0, this, [this] { prefetchOrders(); });
+
+  resize(800, 600);
+}
+
+MainWindow::~MainWindow() {
+  // The import writes through `pool`, which goes away with the window; the
+  // batch being written finishes, the rest are dropped.
+  importing.cancel();
+  importing.waitForFinished();
+}
+
+OrderQuery MainWindow::initialOrdersQuery() {
+  // What HomeScreen asks for with an empty search and the "All" status.
+  OrderQuery query;
+  query.filter = orderSearchFilter({}, std::nullopt);
+  query.sortColumn = OrdersTableModel::IdColumn;
+  query.sortOrder = Qt::DescendingOrder;
+  return query;
+}
+
+void MainWindow::prefetchOrders() {
+  TRACE_SCOPE("MainWindow::prefetchOrders", "ui");
+  pool
+      .read([query = initialOrdersQuery()](Database &d) {
+        return OrdersTableModel::prefetch(d, query);
+      })
+      .then(this, [this](DbResult<OrdersTableModel::Prefetch> r) {
+        if (!r.error.isEmpty()) {
+          qWarning().noquote() << "Orders prefetch failed:" << r.error;
+          return;
+        }
+        // Too late if Orders is already showing its own select().
+        if (!ordersModel) {
+          prefetched = std::move(r.value);
+        }
+      });
+
+  loadCompletions();
+}
+
+QFuture<void> MainWindow::loadCompletions() {
+  return pool
+      .read([](Database &d) {
+        return Completions{PrefixIndex(d.customerFrequencies()),
+                           PrefixIndex(d.productFrequencies())};
+      })
+      .then(this, [this](DbResult<Completions> r) {
+        if (!r.error.isEmpty()) {
+          qWarning().noquote() << "Failed to load completions:" << r.error;
+          return;
+        }
+        completions = std::move(r.value);
+      });
+}
+
+void MainWindow::pollExternalChanges() {
+  if (pollingChanges || !ordersModel) {
+    return;
+  }
+  pollingChanges = true;
+
+  // On the writer, data_version only moves for commits from other
+  // processes: every write of this one goes through that connection, and
+  // its own commits are synced by the handlers that make them.
+  pool.write([](Database &d) { return d.dataVersion(); })
+      .then(this, [this](DbResult<std::optional<long long>> r) {
+        pollingChanges = false;
+        if (!r.value) {
+          return;
+        }
+        if (dataVersion != r.value && ordersModel) {
+          ordersModel->syncChanges();
+        }
+        dataVersion = r.value;
+      });
+}
+
+void MainWindow::pruneChangelog() {
+  if (pruningChangelog) {
+    return;
+  }
+  pruningChangelog = true;
+
+  // One batch per writer job, so writes queued meanwhile go in between.
+  pool.write([](Database &d) {
+        return d.pruneChangelog(kChangelogKeep, kChangelogPruneBatch);
+      })
+      .then(this, [this](DbResult<std::optional<long long>> r) {
+        pruningChangelog = false;
+        if (!r.value) {
+          qWarning().noquote() << "Failed to prune the changelog:" << r.error;
+        } else if (*r.value == kChangelogPruneBatch) {
+          pruneChangelog();
+        }
+      });
+}
+
+void MainWindow::countCompletion(const OrderDraft &order, long long delta) {
+  completions.customers.add(order.customer, delta);
+  completions.products.add(order.product, delta);
+}
+
+HomeScreen *MainWindow::homeScreen() {
+  if (home) {
+    return home;
+  }
+  TRACE_SCOPE("MainWindow::homeScreen", "ui");
+
+  home = new HomeScreen(stack);
+  stack->addWidget(home);
+
   connect(home, &HomeScreen::createOrderRequested, this,
           [this] { handleCreateOrder(); });
 
+  connect(home, &HomeScreen::importOrdersRequested, this,
+          [this] { handleImportOrders(); });
+  connect(home, &HomeScreen::exportOrdersRequested, this,
+          [this] { handleExportOrders(); });
+
   connect(home, &HomeScreen::deleteOrderRequested, this,
           [this](long long orderId) { handleDeleteOrder(orderId); });
 
   connect(home, &HomeScreen::detailsRequested, this,
           [this](long long orderId) { handleOpenDetails(orderId); });
-  connect(detail, &DetailScreen::backRequested, this, [this] { back(); });
 
   connect(home, &HomeScreen::editOrderRequested, this,
           [this](long long orderId) { handleEditOrder(orderId); });
 
-  ordersModel = new QSqlTableModel(this);
-  ordersModel->setTable("orders");
-  ordersModel->setEditStrategy(QSqlTableModel::OnManualSubmit);
-  ordersModel->setSort(0, Qt::DescendingOrder); // id desc
-  ordersModel->select();
-
-  ordersModel->setHeaderData(1, Qt::Horizontal, "Customer");
-  ordersModel->setHeaderData(2, Qt::Horizontal, "Product");
-  ordersModel->setHeaderData(3, Qt::Horizontal, "Qty");
-  ordersModel->setHeaderData(4, Qt::Horizontal, "Status");
-  ordersModel->setHeaderData(5, Qt::Horizontal, "Date");
+  connect(home, &HomeScreen::bulkStatusRequested, this,
+          [this](const OrderSet &orders, OrderStatus status) {
+            handleBulkStatus(orders, status);
+          });
+  connect(home, &HomeScreen::bulkDeleteRequested, this,
+          [this](const OrderSet &orders) { handleBulkDelete(orders); });
+
+  ordersModel = new OrdersTableModel(&pool, &searchDb, this);
+  ordersModel->setSort(OrdersTableModel::IdColumn, Qt::DescendingOrder);
+  if (prefetched) {
+    ordersModel->adoptPrefetch(std::move(*prefetched));
+    prefetched.reset();
+  }
 
+  // Selects unless the prefetched rows already match the screen's filter.
   home->setOrdersModel(ordersModel);
-  resize(800, 600);
+  return home;
+}
+
+DetailScreen *MainWindow::detailScreen() {
+  if (!detail) {
+    detail = new DetailScreen(stack);
+    stack->addWidget(detail);
+    connect(detail, &DetailScreen::backRequested, this, [this] { back(); });
+  }
+  return detail;
+}
+
+DashboardScreen *MainWindow::dashboardScreen() {
+  if (!dashboard) {
+    dashboard = new DashboardScreen(&pool, stack);
+    stack->addWidget(dashboard);
+  }
+  return dashboard;
 }
 
 void MainWindow::goTo(QWidget *next) {
@@ -242,66 +454,249 @@ void MainWindow::back() {
 
 void MainWindow::handleCreateOrder() {
   OrderFormDialog dlg(this);
+  dlg.setCompletions(&completions.customers, &completions.products);
   if (dlg.exec() != QDialog::Accepted) {
     return;
   }
 
   const auto draft = dlg.value();
-  const auto insertedId = db.insertOrder(draft);
-  if (!insertedId) {
-    QMessageBox::critical(this, "Database error", db.lastError());
+  pool.insertOrder(draft)
+      .then(this, [this, draft](DbResult<std::optional<long long>> r) {
+        if (!r.value) {
+          QMessageBox::critical(this, "Database error", r.error);
+          return;
+        }
+        countCompletion(draft, 1);
+
+        if (ordersModel) {
+          ordersModel->syncChanges();
+        }
+      });
+}
+
+void MainWindow::handleImportOrders() {
+  // Two imports would each switch the writer's profile and restore it.
+  if (importing.isRunning()) {
+    QMessageBox::information(this, "Import orders",
+                             "An import is already running.");
     return;
   }
 
-  if (ordersModel) {
-    ordersModel->select();
+  const auto path = QFileDialog::getOpenFileName(
+      this, "Import orders", {}, "Orders (*.json *.csv)");
+  if (path.isEmpty()) {
+    return;
   }
-}
 
-void MainWindow::handleOpenDetails(long long orderId) {
-  std::optional<OrderRow> order = db.getOrder(orderId);
-  if (!order.has_value()) {
+  const auto format = importFormatForPath(path);
+  if (!format) {
+    QMessageBox::information(this, "Import orders",
+                             "Choose a .json or .csv file.");
     return;
   }
 
-  detail->setOrder(*order);
-  goTo(detail);
+  importing = QtConcurrent::run(
+      [this, path, format = *format](QPromise<ImportReport> &promise) {
+        promise.addResult(importThroughWriter(promise, pool, path, format));
+      });
+
+  importing.then(this, [this](const ImportReport &report) {
+    QString summary = QString("Imported %1 orders, rejected %2.")
+                          .arg(report.imported)
+                          .arg(report.rejected);
+    if (!report.problems.isEmpty()) {
+      summary += "\n\n" + report.problems.join("\n");
+    }
+
+    if (!report.error.isEmpty()) {
+      QMessageBox::critical(this, "Import failed",
+                            report.error + "\n\n" + summary);
+    } else {
+      QMessageBox::information(this, "Import orders", summary);
+    }
+
+    if (report.imported > 0) {
+      pruneChangelog();
+      loadCompletions();
+      if (ordersModel) {
+        ordersModel->select();
+      }
+    }
+  });
 }
 
-void MainWindow::handleDeleteOrder(long long orderId) {
-  if (!db.deleteOrder(orderId)) {
-    QMessageBox::critical(this, "Database error", db.lastError());
+void MainWindow::handleExportOrders() {
+  if (!ordersModel) {
     return;
   }
 
-  if (ordersModel) {
-    ordersModel->select();
+  QString selectedFilter;
+  const auto path = QFileDialog::getSaveFileName(
+      this, "Export orders", "orders.jsonl",
+      "JSON Lines (*.jsonl);;CSV (*.csv)", &selectedFilter);
+  if (path.isEmpty()) {
+    return;
   }
+
+  const auto format = exportFormatForPath(path).value_or(
+      selectedFilter.startsWith("CSV") ? ExportFormat::Csv
+                                       : ExportFormat::JsonLines);
+  const auto query = ordersModel->currentQuery();
+
+  // On a reader, so edits go on while a large export runs.
+  auto future = pool.reader().runTask<ExportReport>(
+      [query, path, format](Database &d,
+                            QPromise<DbResult<ExportReport>> &promise) {
+        auto progress = [&promise](long long written, long long total) {
+          promise.setProgressRange(0, static_cast<int>(total));
+          promise.setProgressValue(static_cast<int>(written));
+          return !promise.isCanceled();
+        };
+        return exportOrders(d, query, path, format, progress);
+      });
+
+  auto *progress =
+      new QProgressDialog("Exporting orders...", "Cancel", 0, 0, this);
+  progress->setWindowModality(Qt::WindowModal);
+  progress->setMinimumDuration(500);
+
+  auto *watcher = new QFutureWatcher<DbResult<ExportReport>>(progress);
+  connect(watcher, &QFutureWatcherBase::progressRangeChanged, progress,
+          &QProgressDialog::setRange);
+  connect(watcher, &QFutureWatcherBase::progressValueChanged, progress,
+          &QProgressDialog::setValue);
+  connect(progress, &QProgressDialog::canceled, watcher,
+          &QFutureWatcherBase::cancel);
+  connect(watcher, &QFutureWatcherBase::finished, this,
+          [this, watcher, progress] {
+            progress->deleteLater();
+
+            if (watcher->isCanceled()) {
+              QMessageBox::information(this, "Export orders",
+                                       "Export canceled.");
+              return;
+            }
+
+            const auto report = watcher->result().value;
+            if (!report.error.isEmpty()) {
+              QMessageBox::critical(this, "Export failed", report.error);
+              return;
+            }
+            QMessageBox::information(
+                this, "Export orders",
+                QString("Exported %1 orders.").arg(report.exported));
+          });
+  watcher->setFuture(future);
 }
 
-void MainWindow::handleEditOrder(long long orderId) {
-  std::optional<OrderRow> order = db.getOrder(orderId);
-  if (!order.has_value()) {
-    if (!db.lastError().isEmpty()) {
-      QMessageBox::critical(this, "Database error", db.lastError());
-    } else {
-      QMessageBox::information(this, "Not found",
-                               QString("Order #%1 not found.").arg(orderId));
+void MainWindow::handleOpenDetails(long long orderId) {
+  if (ordersModel) {
+    if (const auto cached = ordersModel->cachedOrder(orderId)) {
+      auto *detail = detailScreen();
+      detail->setOrder(*cached);
+      goTo(detail);
+      return;
     }
-    return;
   }
 
-  OrderFormDialog dlg(*order, this);
-  if (dlg.exec() != QDialog::Accepted) {
-    return;
-  }
+  pool.getOrder(orderId).then(
+      this, [this](DbResult<std::optional<OrderRow>> r) {
+        if (!r.value.has_value()) {
+          return;
+        }
 
-  if (!db.updateOrder(orderId, dlg.value())) {
-    QMessageBox::critical(this, "Database error", db.lastError());
-    return;
-  }
+        auto *detail = detailScreen();
+        detail->setOrder(*r.value);
+        goTo(detail);
+      });
+}
 
+void MainWindow::handleDeleteOrder(long long orderId) {
+  std::optional<OrderRow> deleted;
   if (ordersModel) {
-    ordersModel->select();
+    deleted = ordersModel->cachedOrder(orderId);
   }
+
+  pool.deleteOrder(orderId).then(
+      this, [this, deleted](DbResult<bool> r) {
+        if (!r.value) {
+          QMessageBox::critical(this, "Database error", r.error);
+          return;
+        }
+        if (deleted) {
+          countCompletion({deleted->customer, deleted->product}, -1);
+        }
+
+        if (ordersModel) {
+          ordersModel->syncChanges();
+        }
+      });
+}
+
+void MainWindow::handleEditOrder(long long orderId) {
+  pool.getOrder(orderId).then(
+      this, [this, orderId](DbResult<std::optional<OrderRow>> r) {
+        if (!r.value.has_value()) {
+          if (!r.error.isEmpty()) {
+            QMessageBox::critical(this, "Database error", r.error);
+          } else {
+            QMessageBox::information(
+                this, "Not found",
+                QString("Order #%1 not found.").arg(orderId));
+          }
+          return;
+        }
+
+        OrderFormDialog dlg(*r.value, this);
+        dlg.setCompletions(&completions.customers, &completions.products);
+        if (dlg.exec() != QDialog::Accepted) {
+          return;
+        }
+
+        const OrderDraft before{r.value->customer, r.value->product};
+        const auto after = dlg.value();
+        pool.updateOrder(orderId, after)
+            .then(this, [this, before, after](DbResult<bool> updated) {
+              if (!updated.value) {
+                QMessageBox::critical(this, "Database error", updated.error);
+                return;
+              }
+              countCompletion(before, -1);
+              countCompletion(after, 1);
+
+              if (ordersModel) {
+                ordersModel->syncChanges();
+              }
+            });
+      });
+}
+
+void MainWindow::handleBulkStatus(const OrderSet &orders,
+                                  OrderStatus status) {
+  OrderEdit edit;
+  edit.status = status;
+  pool.updateOrders(orders, edit)
+      .then(this, [this](DbResult<std::optional<long long>> r) {
+        if (!r.value) {
+          QMessageBox::critical(this, "Database error", r.error);
+          return;
+        }
+        if (ordersModel) {
+          ordersModel->syncChanges();
+        }
+      });
+}
+
+void MainWindow::handleBulkDelete(const OrderSet &orders) {
+  pool.deleteOrders(orders).then(
+      this, [this](DbResult<std::optional<long long>> r) {
+        if (!r.value) {
+          QMessageBox::critical(this, "Database error", r.error);
+          return;
+        }
+        loadCompletions();
+        if (ordersModel) {
+          ordersModel->syncChanges();
+        }
+      });
 }
@@ -1,39 +1,102 @@
 #pragma once
 
+#include <QFuture>
 #include <QMainWindow>
-#include <QSqlTableModel>
 #include <QStackedWidget>
+#include <memory>
+#include <optional>
 #include <vector>
 
+#include "async_database.h"
+#include "connection_pool.h"
+#include "dashboard_screen.h"
 #include "database.h"
 #include "detail_screen.h"
 #include "home_screen.h"
 #include "login_screen.h"
+#include "order_import.h"
+#include "orders_table_model.h"
+#include "prefix_index.h"
 
 class QSplitter;
 
 class MainWindow final : public QMainWindow {
 public:
-  explicit MainWindow(QWidget *parent = nullptr);
+  // `profile` applies to the writer connection that serves the login and
+  // order edits; migrations always use the interactive profile.
+  // `passwordCost` is the PBKDF2 iteration count for new password hashes.
+  // `readers` is the number of read-only connections for the orders list,
+  // details, exports and the dashboard.
+  explicit MainWindow(
+      ConnectionProfile profile = ConnectionProfile::Interactive,
+      int passwordCost = kDefaultPasswordCost,
+      int readers = kDefaultReaders, QWidget *parent = nullptr);
+  ~MainWindow() override;
+
+  static constexpr int kDefaultReaders = 2;
 
 private:
+  // How often to check for commits from other app instances.
+  static constexpr int kChangePollMs = 1000;
+  // Changelog entries kept for instances that have fallen behind; one
+  // further back than this re-reads its rows instead.
+  static constexpr long long kChangelogKeep = 100'000;
+  // Entries dropped per writer job when pruning.
+  static constexpr long long kChangelogPruneBatch = 10'000;
+
   Database db;
-  QSqlTableModel *ordersModel;
+  ConnectionPool pool;
+  // Runs only the orders screen's search counts, so a superseded one can be
+  // interrupted.
+  AsyncDatabase searchDb{"orders_search"};
+  std::optional<OrdersTableModel::Prefetch> prefetched;
+  // Import running on a worker thread; it writes through `pool`.
+  QFuture<ImportReport> importing;
+
+  // Type-ahead for the order form, by number of orders.
+  struct Completions {
+    PrefixIndex customers;
+    PrefixIndex products;
+  };
+  Completions completions;
+  OrdersTableModel *ordersModel = nullptr;
   QSplitter *rootSplitter;
   int sidebarLastWidth;
   QStackedWidget *stack;
 
-  HomeScreen *home;
-  DetailScreen *detail;
+  // Built on first navigation, see homeScreen() and friends.
+  HomeScreen *home = nullptr;
+  DetailScreen *detail = nullptr;
+  DashboardScreen *dashboard = nullptr;
   LoginScreen *login;
 
   std::vector<QWidget *> history;
 
+  HomeScreen *homeScreen();
+  DetailScreen *detailScreen();
+  DashboardScreen *dashboardScreen();
+  static OrderQuery initialOrdersQuery();
+  void prefetchOrders();
+  // Rebuilds `completions` from the summary tables on a reader.
+  QFuture<void> loadCompletions();
+  void countCompletion(const OrderDraft &order, long long delta);
+  // Syncs the orders list when another process has committed.
+  void pollExternalChanges();
+  void pruneChangelog();
+
   void goTo(QWidget *next);
   void back();
   void handleCreateOrder();
+  void handleImportOrders();
+  void handleExportOrders();
   void handleDeleteOrder(long long orderId);
   void handleOpenDetails(long long orderId);
   void handleEditOrder(long long orderId);
+  void handleBulkStatus(const OrderSet &orders, OrderStatus status);
+  void handleBulkDelete(const OrderSet &orders);
   bool isAuthenticated = false;
+  // Last PRAGMA data_version seen on the writer.
+  std::optional<long long> dataVersion;
+  bool pollingChanges = false;
+  bool pruningChangelog = false;
 };
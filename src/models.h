@@ -2,11 +2,48 @@
 
 #include <QDate>
 #include <QString>
+#include <QStringList>
+#include <optional>
+
+// Stored as this integer in orders.status; the statuses table holds the
+// same ids and names. Values are in lifecycle order, so sorting by status
+// follows the order's progress.
+enum class OrderStatus : quint8 {
+  Pending = 0,
+  Processing = 1,
+  Shipped = 2,
+  Delivered = 3,
+  Cancelled = 4,
+};
+
+// Status names, indexed by OrderStatus value.
+inline const QStringList &orderStatuses() {
+  static const QStringList statuses = {"pending", "processing", "shipped",
+                                       "delivered", "cancelled"};
+  return statuses;
+}
+
+// "unknown" for a value outside the enum, e.g. one read from a database
+// written by a newer version.
+inline const QString &orderStatusName(OrderStatus status) {
+  static const QString unknown = "unknown";
+  const auto index = static_cast<qsizetype>(status);
+  return index < orderStatuses().size() ? orderStatuses().at(index)
+                                        : unknown;
+}
+
+inline std::optional<OrderStatus> orderStatusFromName(const QString &name) {
+  const auto index = orderStatuses().indexOf(name.trimmed().toLower());
+  if (index < 0) {
+    return std::nullopt;
+  }
+  return static_cast<OrderStatus>(index);
+}
 
 struct OrderDraft {
   QString customer;
   QString product;
   int quantity = 0;
-  QString status;
+  OrderStatus status = OrderStatus::Pending;
   QDate orderDate;
 };
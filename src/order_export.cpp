@@ -0,0 +1,185 @@
+#include "order_export.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace {
+constexpr qsizetype kFlushBytes = 1 << 20;
+constexpr long long kProgressEvery = 10'000;
+
+// Collects output in memory and writes it to the file in large chunks.
+class BufferedWriter final {
+public:
+  explicit BufferedWriter(const QString &path) : file(path) {
+    buffer.reserve(kFlushBytes + 4096);
+  }
+
+  bool open() { return file.open(QIODevice::WriteOnly | QIODevice::Truncate); }
+
+  bool write(QByteArrayView bytes) {
+    buffer.append(bytes);
+    return buffer.size() < kFlushBytes || flush();
+  }
+
+  bool flush() {
+    if (buffer.isEmpty()) {
+      return true;
+    }
+    const bool ok = file.write(buffer) == buffer.size();
+    buffer.resize(0); // keeps the capacity
+    return ok;
+  }
+
+  bool close() {
+    const bool ok = flush();
+    file.close();
+    return ok && file.error() == QFileDevice::NoError;
+  }
+
+  void discard() {
+    file.close();
+    file.remove();
+  }
+
+  QString errorString() const { return file.errorString(); }
+
+private:
+  QFile file;
+  QByteArray buffer;
+};
+
+void appendCsvField(QByteArray &line, const QString &value) {
+  auto utf8 = value.toUtf8();
+  const bool needsQuotes = utf8.contains(',') || utf8.contains('"') ||
+                           utf8.contains('\n') || utf8.contains('\r');
+  if (!needsQuotes) {
+    line += utf8;
+    return;
+  }
+  line += '"';
+  line += utf8.replace("\"", "\"\"");
+  line += '"';
+}
+
+void appendCsvLine(QByteArray &line, const OrderRow &r) {
+  line += QByteArray::number(r.id);
+  line += ',';
+  appendCsvField(line, r.customer);
+  line += ',';
+  appendCsvField(line, r.product);
+  line += ',';
+  line += QByteArray::number(r.quantity);
+  line += ',';
+  line += orderStatusName(r.status).toLatin1();
+  line += ',';
+  line += r.orderDate.toString(Qt::ISODate).toLatin1();
+  line += '\n';
+}
+
+void appendJsonLine(QByteArray &line, const OrderRow &r) {
+  // Same keys the importer reads, in column order.
+  const nlohmann::ordered_json j = {
+      {"id", r.id},
+      {"customer", r.customer.toStdString()},
+      {"product", r.product.toStdString()},
+      {"quantity", r.quantity},
+      {"status", orderStatusName(r.status).toStdString()},
+      {"order_date", r.orderDate.toString(Qt::ISODate).toStdString()},
+  };
+  const auto text = j.dump();
+  line.append(text.data(), static_cast<qsizetype>(text.size()));
+  line += '\n';
+}
+} // namespace
+
+std::optional<ExportFormat> exportFormatForPath(const QString &path) {
+  const auto suffix = QFileInfo(path).suffix().toLower();
+  if (suffix == "jsonl" || suffix == "ndjson") {
+    return ExportFormat::JsonLines;
+  }
+  if (suffix == "csv") {
+    return ExportFormat::Csv;
+  }
+  return std::nullopt;
+}
+
+ExportReport exportOrders(Database &db, const OrderQuery &query,
+                          const QString &path, ExportFormat format,
+                          const ExportProgress &progress) {
+  ExportReport report;
+  ScopedProfile reporting(db, ConnectionProfile::ReadOnlyReporting);
+
+  long long total = 0;
+  if (progress) {
+    const auto count = db.countOrders(query);
+    if (!count) {
+      report.error = db.lastError();
+      return report;
+    }
+    total = *count;
+    if (!progress(0, total)) {
+      report.canceled = true;
+      return report;
+    }
+  }
+
+  BufferedWriter out(path);
+  if (!out.open()) {
+    report.error = out.errorString();
+    return report;
+  }
+  if (format == ExportFormat::Csv &&
+      !out.write("id,customer,product,quantity,status,order_date\n")) {
+    report.error = out.errorString();
+    out.discard();
+    return report;
+  }
+
+  QByteArray line;
+  bool writeFailed = false;
+  const bool read = db.forEachOrder(query, [&](const OrderRow &r) {
+    line.resize(0);
+    if (format == ExportFormat::Csv) {
+      appendCsvLine(line, r);
+    } else {
+      appendJsonLine(line, r);
+    }
+
+    if (!out.write(line)) {
+      writeFailed = true;
+      return false;
+    }
+
+    ++report.exported;
+    if (progress && report.exported % kProgressEvery == 0 &&
+        !progress(report.exported, total)) {
+      report.canceled = true;
+      return false;
+    }
+    return true;
+  });
+
+  if (!read) {
+    report.error = db.lastError();
+  } else if (writeFailed) {
+    report.error = out.errorString();
+  }
+  if (report.canceled || !report.error.isEmpty()) {
+    out.discard();
+    return report;
+  }
+
+  if (!out.close()) {
+    report.error = out.errorString();
+    out.discard();
+    return report;
+  }
+
+  if (progress) {
+    progress(report.exported, total);
+  }
+  return report;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QString>
+#include <functional>
+#include <optional>
+
+#include "database.h"
+
+enum class ExportFormat { JsonLines, Csv };
+
+struct ExportReport {
+  long long exported = 0;
+  bool canceled = false;
+  QString error;
+};
+
+// Picks the format from the file suffix (.jsonl/.ndjson or .csv).
+std::optional<ExportFormat> exportFormatForPath(const QString &path);
+
+// Called as rows are written; return false to cancel the export.
+using ExportProgress = std::function<bool(long long written, long long total)>;
+
+// Streams the orders matching `query`, in query order, to `path`. Rows go
+// from a forward-only cursor through a fixed-size write buffer, so memory
+// use does not depend on the number of rows. A canceled or failed export
+// removes the partial file.
+ExportReport exportOrders(Database &db, const OrderQuery &query,
+                          const QString &path, ExportFormat format,
+                          const ExportProgress &progress = {});
@@ -0,0 +1,64 @@
+#include "order_filter.h"
+
+#include <QRegularExpression>
+#include <QStringList>
+
+#include "models.h"
+
+namespace {
+// Every whitespace-separated word becomes a quoted prefix query, so user
+// input can never be read as FTS5 operators. Words are ANDed together.
+QString ftsMatchExpression(const QString &term) {
+  static const QRegularExpression whitespace("\\s+");
+
+  QStringList tokens;
+  for (auto word : term.split(whitespace, Qt::SkipEmptyParts)) {
+    word.remove('"');
+    if (!word.isEmpty()) {
+      tokens << QString("\"%1\"*").arg(word);
+    }
+  }
+  return tokens.join(' ');
+}
+} // namespace
+
+QString escapeSqlString(QString s) { return s.replace("'", "''"); }
+
+QString orderSearchFilter(const QString &term,
+                          std::optional<OrderStatus> status) {
+  QStringList parts;
+
+  const auto t = term.trimmed();
+  if (!t.isEmpty()) {
+    QStringList matches;
+
+    const auto match = ftsMatchExpression(t);
+    if (!match.isEmpty()) {
+      matches << QString("id IN (SELECT rowid FROM orders_fts WHERE "
+                         "orders_fts MATCH '%1')")
+                     .arg(escapeSqlString(match));
+    }
+
+    // Statuses are a closed set; matching their names here turns the term
+    // into an integer lookup on idx_orders_status.
+    QStringList statusHits;
+    for (qsizetype i = 0; i < orderStatuses().size(); ++i) {
+      if (orderStatuses().at(i).startsWith(t, Qt::CaseInsensitive)) {
+        statusHits << QString::number(i);
+      }
+    }
+    if (!statusHits.isEmpty()) {
+      matches << QString("status IN (%1)").arg(statusHits.join(", "));
+    }
+
+    // Nothing searchable in the term (e.g. only punctuation).
+    parts << (matches.isEmpty() ? QString("0")
+                                : "(" + matches.join(" OR ") + ")");
+  }
+
+  if (status) {
+    parts << QString("status = %1").arg(static_cast<int>(*status));
+  }
+
+  return parts.join(" AND ");
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QString>
+#include <optional>
+
+#include "models.h"
+
+// WHERE fragment for the orders list: the search term is matched as token
+// prefixes against the orders_fts index, the status exactly (nullopt for
+// any status).
+QString orderSearchFilter(const QString &term,
+                          std::optional<OrderStatus> status);
+
+QString escapeSqlString(QString s);
@@ -1,8 +1,39 @@
 #include "order_form_dialog.h"
 
+#include <QAbstractItemView>
+#include <QCompleter>
 #include <QFormLayout>
+#include <QStringListModel>
 #include <QVBoxLayout>
 
+namespace {
+constexpr int kSuggestions = 8;
+
+// The index already filters and ranks, so the completer shows its list as
+// is instead of filtering again.
+void attachCompleter(QLineEdit &edit, const PrefixIndex *index) {
+  auto *model = new QStringListModel(&edit);
+  auto *completer = new QCompleter(model, &edit);
+  completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+  completer->setCaseSensitivity(Qt::CaseInsensitive);
+  edit.setCompleter(completer);
+
+  QObject::connect(&edit, &QLineEdit::textEdited, completer,
+                   [completer, model, index](const QString &text) {
+                     const auto matches =
+                         text.trimmed().isEmpty()
+                             ? QStringList()
+                             : index->topMatches(text, kSuggestions);
+                     model->setStringList(matches);
+                     if (matches.isEmpty()) {
+                       completer->popup()->hide();
+                     } else {
+                       completer->complete();
+                     }
+                   });
+}
+} // namespace
+
 OrderFormDialog::OrderFormDialog(QWidget *parent) : QDialog(parent) {
   initUI("Create Order");
 }
@@ -14,9 +45,7 @@ OrderFormDialog::OrderFormDialog(const OrderRow &existing, QWidget *parent)
   productEdit.setText(existing.product);
   quantitySpin.setValue(existing.quantity);
 
-  if (statusCombo.findText(existing.status) >= 0) {
-    statusCombo.setCurrentText(existing.status);
-  }
+  statusCombo.setCurrentIndex(static_cast<int>(existing.status));
   if (existing.orderDate.isValid()) {
     dateEdit.setDate(existing.orderDate);
   }
@@ -31,8 +60,8 @@ void OrderFormDialog::initUI(const QString &windowTitle) {
   quantitySpin.setRange(1, 1000000);
   quantitySpin.setValue(1);
 
-  statusCombo.addItems(
-      {"pending", "processing", "shipped", "delivered", "cancelled"});
+  // Item index == OrderStatus value.
+  statusCombo.addItems(orderStatuses());
 
   dateEdit.setCalendarPopup(true);
   dateEdit.setDate(QDate::currentDate());
@@ -62,6 +91,12 @@ void OrderFormDialog::initUI(const QString &windowTitle) {
   connect(&buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
 }
 
+void OrderFormDialog::setCompletions(const PrefixIndex *customers,
+                                     const PrefixIndex *products) {
+  attachCompleter(customerEdit, customers);
+  attachCompleter(productEdit, products);
+}
+
 void OrderFormDialog::onSubmit() {
   errorLabel.hide();
   errorLabel.clear();
@@ -79,7 +114,7 @@ void OrderFormDialog::onSubmit() {
   draft.customer = customer;
   draft.product = product;
   draft.quantity = quantitySpin.value();
-  draft.status = statusCombo.currentText();
+  draft.status = static_cast<OrderStatus>(statusCombo.currentIndex());
   draft.orderDate = dateEdit.date();
 
   accept();
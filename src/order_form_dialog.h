@@ -10,6 +10,7 @@
 
 #include "database.h"
 #include "models.h"
+#include "prefix_index.h"
 
 class OrderFormDialog final : public QDialog {
 public:
@@ -17,6 +18,10 @@ public:
   OrderFormDialog(const OrderRow &existing, QWidget *parent = nullptr);
 
   OrderDraft value() const { return draft; }
+  // Suggests the most used matching names while typing. The indexes must
+  // outlive the dialog.
+  void setCompletions(const PrefixIndex *customers,
+                      const PrefixIndex *products);
 
 private:
   QLineEdit customerEdit;
@@ -0,0 +1,395 @@
+#include "order_import.h"
+
+#include <QFileInfo>
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "models.h"
+
+namespace {
+// Small enough that one batch holds the writer for well under a second.
+constexpr std::size_t kImportBatchSize = 10'000;
+constexpr int kMaxReportedProblems = 20;
+
+// Text of one input record before validation.
+struct RawOrder {
+  QString customer;
+  QString product;
+  QString quantity;
+  QString status;
+  QString orderDate;
+};
+
+using RawField = QString RawOrder::*;
+
+// Maps a JSON key or CSV header onto a RawOrder field; null if unknown.
+RawField fieldFor(const QString &name) {
+  const auto key = name.trimmed().toLower();
+  if (key == "customer") {
+    return &RawOrder::customer;
+  }
+  if (key == "product") {
+    return &RawOrder::product;
+  }
+  if (key == "quantity" || key == "qty") {
+    return &RawOrder::quantity;
+  }
+  if (key == "status") {
+    return &RawOrder::status;
+  }
+  if (key == "order_date" || key == "orderdate" || key == "date") {
+    return &RawOrder::orderDate;
+  }
+  return nullptr;
+}
+
+std::optional<OrderDraft> validateOrder(const RawOrder &raw, QString &err) {
+  OrderDraft o;
+
+  o.customer = raw.customer.trimmed();
+  if (o.customer.isEmpty()) {
+    err = "customer is required";
+    return std::nullopt;
+  }
+
+  o.product = raw.product.trimmed();
+  if (o.product.isEmpty()) {
+    err = "product is required";
+    return std::nullopt;
+  }
+
+  bool ok = false;
+  o.quantity = raw.quantity.trimmed().toInt(&ok);
+  if (!ok || o.quantity < 1) {
+    err = QString("invalid quantity '%1'").arg(raw.quantity);
+    return std::nullopt;
+  }
+
+  const auto status = orderStatusFromName(raw.status);
+  if (!status) {
+    err = QString("unknown status '%1'").arg(raw.status);
+    return std::nullopt;
+  }
+  o.status = *status;
+
+  o.orderDate = QDate::fromString(raw.orderDate.trimmed(), Qt::ISODate);
+  if (!o.orderDate.isValid()) {
+    err = QString("invalid order date '%1'").arg(raw.orderDate);
+    return std::nullopt;
+  }
+
+  return o;
+}
+
+// Validates records and writes accepted ones a batch at a time.
+class BatchWriter final {
+public:
+  BatchWriter(const ImportSink &sink, ImportReport &report)
+      : sink(sink), report(report) {
+    batch.reserve(kImportBatchSize);
+  }
+
+  void reject(long long recordNo, const QString &why) {
+    ++report.rejected;
+    if (report.problems.size() < kMaxReportedProblems) {
+      report.problems << QString("Record %1: %2").arg(recordNo).arg(why);
+    }
+  }
+
+  bool add(long long recordNo, const RawOrder &raw) {
+    QString err;
+    auto order = validateOrder(raw, err);
+    if (!order) {
+      reject(recordNo, err);
+      return true;
+    }
+
+    batch.push_back(std::move(*order));
+    return batch.size() < kImportBatchSize || flush();
+  }
+
+  bool flush() {
+    if (batch.empty()) {
+      return true;
+    }
+    const auto written = static_cast<long long>(batch.size());
+    const auto err = sink(std::exchange(batch, {}));
+    batch.reserve(kImportBatchSize);
+    if (!err.isEmpty()) {
+      report.error = err;
+      return false;
+    }
+    report.imported += written;
+    return true;
+  }
+
+private:
+  const ImportSink &sink;
+  ImportReport &report;
+  std::vector<OrderDraft> batch;
+};
+
+// SAX consumer for `[ {order}, {order}, ... ]`. Only the current record is
+// held in memory; unknown keys and nested values are skipped.
+class OrderJsonSax final : public nlohmann::json_sax<nlohmann::json> {
+public:
+  OrderJsonSax(BatchWriter &writer, ImportReport &report)
+      : writer(writer), report(report) {}
+
+  bool null() override { return scalar({}); }
+  bool boolean(bool val) override { return scalar(val ? "true" : "false"); }
+  bool number_integer(number_integer_t val) override {
+    return scalar(QString::number(val));
+  }
+  bool number_unsigned(number_unsigned_t val) override {
+    return scalar(QString::number(val));
+  }
+  bool number_float(number_float_t, const string_t &s) override {
+    return scalar(QString::fromStdString(s));
+  }
+  bool string(string_t &val) override {
+    return scalar(QString::fromStdString(val));
+  }
+  bool binary(binary_t &) override { return scalar({}); }
+
+  bool start_object(std::size_t) override {
+    if (depth == 0) {
+      return fail("expected a JSON array of orders");
+    }
+    if (depth == 1) {
+      current = {};
+      ++recordNo;
+    }
+    field = nullptr;
+    ++depth;
+    return true;
+  }
+
+  bool key(string_t &val) override {
+    field = nullptr;
+    if (depth == 2) {
+      if (auto f = fieldFor(QString::fromStdString(val))) {
+        field = &(current.*f);
+      }
+    }
+    return true;
+  }
+
+  bool end_object() override {
+    --depth;
+    field = nullptr;
+    return depth != 1 || writer.add(recordNo, current);
+  }
+
+  bool start_array(std::size_t) override {
+    if (depth == 1) {
+      writer.reject(++recordNo, "expected an order object");
+    }
+    field = nullptr;
+    ++depth;
+    return true;
+  }
+
+  bool end_array() override {
+    --depth;
+    return true;
+  }
+
+  bool parse_error(std::size_t position, const std::string &,
+                   const nlohmann::detail::exception &ex) override {
+    return fail(QString("JSON parse error at byte %1: %2")
+                    .arg(position)
+                    .arg(QString::fromUtf8(ex.what())));
+  }
+
+private:
+  BatchWriter &writer;
+  ImportReport &report;
+  RawOrder current;
+  QString *field = nullptr;
+  int depth = 0;
+  long long recordNo = 0;
+
+  bool scalar(const QString &text) {
+    if (depth == 0) {
+      return fail("expected a JSON array of orders");
+    }
+    if (depth == 1) {
+      writer.reject(++recordNo, "expected an order object");
+    } else if (field) {
+      *field = text;
+    }
+    field = nullptr;
+    return true;
+  }
+
+  bool fail(const QString &msg) {
+    if (report.error.isEmpty()) {
+      report.error = msg;
+    }
+    return false;
+  }
+};
+
+// RFC 4180 record reader: fields may be quoted, quotes inside a quoted
+// field are doubled, and a quoted field may span lines.
+class CsvReader final {
+public:
+  explicit CsvReader(std::istream &in) : in(in) {}
+
+  // Reads the next record into `fields`; false at end of input.
+  bool next(std::vector<std::string> &fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+    bool any = false;
+
+    for (int c = in.get(); c != std::char_traits<char>::eof(); c = in.get()) {
+      any = true;
+
+      if (quoted) {
+        if (c != '"') {
+          field += static_cast<char>(c);
+        } else if (in.peek() == '"') {
+          field += '"';
+          in.get();
+        } else {
+          quoted = false;
+        }
+        continue;
+      }
+
+      switch (c) {
+      case '"':
+        quoted = true;
+        break;
+      case ',':
+        fields.push_back(std::move(field));
+        field.clear();
+        break;
+      case '\r':
+        break;
+      case '\n':
+        fields.push_back(std::move(field));
+        return true;
+      default:
+        field += static_cast<char>(c);
+      }
+    }
+
+    if (!any) {
+      return false;
+    }
+    fields.push_back(std::move(field));
+    return true;
+  }
+
+private:
+  std::istream &in;
+};
+
+void importJson(std::istream &in, BatchWriter &writer, ImportReport &report) {
+  OrderJsonSax sax(writer, report);
+  if (nlohmann::json::sax_parse(in, &sax)) {
+    writer.flush();
+  }
+}
+
+void importCsv(std::istream &in, BatchWriter &writer, ImportReport &report) {
+  CsvReader reader(in);
+  std::vector<std::string> fields;
+
+  if (!reader.next(fields)) {
+    report.error = "CSV file is empty.";
+    return;
+  }
+  if (!fields.empty() && fields[0].starts_with("\xEF\xBB\xBF")) {
+    fields[0].erase(0, 3);
+  }
+
+  std::vector<RawField> columns;
+  for (const auto &name : fields) {
+    columns.push_back(fieldFor(QString::fromStdString(name)));
+  }
+  for (auto required : {&RawOrder::customer, &RawOrder::product,
+                        &RawOrder::quantity, &RawOrder::status,
+                        &RawOrder::orderDate}) {
+    if (std::find(columns.begin(), columns.end(), required) ==
+        columns.end()) {
+      report.error = "CSV header must name customer, product, quantity, "
+                     "status and order_date columns.";
+      return;
+    }
+  }
+  long long recordNo = 0;
+  RawOrder raw;
+  while (reader.next(fields)) {
+    if (fields.size() == 1 && fields[0].empty()) {
+      continue;
+    }
+
+    ++recordNo;
+    raw = {};
+    const auto n = std::min(fields.size(), columns.size());
+    for (std::size_t i = 0; i < n; ++i) {
+      if (columns[i]) {
+        raw.*columns[i] = QString::fromStdString(fields[i]);
+      }
+    }
+    if (!writer.add(recordNo, raw)) {
+      return;
+    }
+  }
+
+  writer.flush();
+}
+} // namespace
+
+std::optional<ImportFormat> importFormatForPath(const QString &path) {
+  const auto suffix = QFileInfo(path).suffix().toLower();
+  if (suffix == "json") {
+    return ImportFormat::Json;
+  }
+  if (suffix == "csv") {
+    return ImportFormat::Csv;
+  }
+  return std::nullopt;
+}
+
+ImportReport importOrders(const QString &path, ImportFormat format,
+                          const ImportSink &sink) {
+  ImportReport report;
+
+  std::vector<char> buffer(1 << 20);
+  std::ifstream in;
+  in.rdbuf()->pubsetbuf(buffer.data(),
+                        static_cast<std::streamsize>(buffer.size()));
+  in.open(std::filesystem::path(path.toStdU16String()), std::ios::binary);
+  if (!in) {
+    report.error = "Failed to open " + path;
+    return report;
+  }
+
+  BatchWriter writer(sink, report);
+  if (format == ImportFormat::Json) {
+    importJson(in, writer, report);
+  } else {
+    importCsv(in, writer, report);
+  }
+
+  return report;
+}
+
+ImportReport importOrders(Database &db, const QString &path,
+                          ImportFormat format) {
+  ScopedProfile ingest(db, ConnectionProfile::BulkIngest);
+  return importOrders(path, format, [&db](std::vector<OrderDraft> batch) {
+    return db.insertOrders(batch) ? QString() : db.lastError();
+  });
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <vector>
+
+#include "database.h"
+
+enum class ImportFormat { Json, Csv };
+
+struct ImportReport {
+  long long imported = 0;
+  long long rejected = 0;
+  QStringList problems; // first few rejected records, for the user
+  QString error;        // parse or database failure that stopped the run
+};
+
+// Picks the format from the file suffix (.json or .csv).
+std::optional<ImportFormat> importFormatForPath(const QString &path);
+
+// Writes one batch of validated orders; returns the error text, empty on
+// success.
+using ImportSink = std::function<QString(std::vector<OrderDraft> batch)>;
+
+// Streams orders from `path` to `sink`. JSON input is a top-level array of
+// order objects read through nlohmann's SAX parser; CSV input has a header
+// row naming the columns. Records are validated one at a time and handed
+// over in batches of at most 10,000, so memory use depends on the batch
+// size and not on the file size. Batches written before an error stay in
+// the database.
+//
+// The sink may run each batch as its own job on a database thread, so
+// other work queued there gets in between batches.
+ImportReport importOrders(const QString &path, ImportFormat format,
+                          const ImportSink &sink);
+// Imports on the calling thread, one transaction per batch, under the
+// bulk-ingest profile.
+ImportReport importOrders(Database &db, const QString &path,
+                          ImportFormat format);
@@ -0,0 +1,240 @@
+#include "order_snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+
+#include "trace.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// Rows per unit of work: big enough to amortize the shared counter, small
+// enough that a slower core does not leave the others idle at the end.
+constexpr std::size_t kChunkRows = 64 * 1024;
+
+// Matches days d with after < d < before.
+struct DayWindow {
+  qint32 after;
+  qint32 before;
+};
+
+DayWindow dayWindow(const QDate &from, const QDate &to) {
+  constexpr qint64 lowest = std::numeric_limits<qint32>::min();
+  constexpr qint64 highest = std::numeric_limits<qint32>::max();
+  // lowest is CompactOrder::kNoDate, which an open window must not match.
+  const qint64 first = from.isValid() ? from.toJulianDay() : lowest + 1;
+  const qint64 end = to.isValid() ? to.toJulianDay() : highest;
+  return {static_cast<qint32>(std::clamp(first - 1, lowest, highest)),
+          static_cast<qint32>(std::clamp(end, lowest, highest))};
+}
+
+int workerCount(int threads, std::size_t rows) {
+  if (threads <= 0) {
+    threads = static_cast<int>(
+        std::max(1u, std::thread::hardware_concurrency()));
+  }
+  const auto chunks = (rows + kChunkRows - 1) / kChunkRows;
+  return static_cast<int>(std::clamp<std::size_t>(
+      chunks, 1, static_cast<std::size_t>(threads)));
+}
+
+// Calls work(worker, begin, end) for every chunk of [0, rows). Workers
+// claim the next chunk from a shared counter, so the split adapts to cores
+// that run slower or start late. The calling thread is worker 0.
+template <typename Work>
+void forEachChunk(std::size_t rows, int workers, const Work &work) {
+  std::atomic<std::size_t> next = 0;
+  const auto run = [&](int worker) {
+    for (auto begin = next.fetch_add(kChunkRows); begin < rows;
+         begin = next.fetch_add(kChunkRows)) {
+      work(worker, begin, std::min(rows, begin + kChunkRows));
+    }
+  };
+
+  std::vector<std::jthread> helpers;
+  helpers.reserve(static_cast<std::size_t>(workers - 1));
+  for (int w = 1; w < workers; ++w) {
+    helpers.emplace_back(run, w);
+  }
+  run(0);
+}
+
+void addQuantities(const qint32 *days, const quint8 *statuses,
+                   const qint32 *quantities, std::size_t n, DayWindow window,
+                   StatusQuantities &out) {
+  StatusQuantities sums{};
+  std::size_t i = 0;
+#if defined(__AVX2__)
+  // Eight rows per step: compare the dates, mask the quantities, then add
+  // them into one 64-bit accumulator per status.
+  const auto after = _mm256_set1_epi32(window.after);
+  const auto before = _mm256_set1_epi32(window.before);
+  __m256i codes[kOrderStatusCount];
+  __m256i lanes[kOrderStatusCount];
+  for (std::size_t s = 0; s < kOrderStatusCount; ++s) {
+    codes[s] = _mm256_set1_epi32(static_cast<int>(s));
+    lanes[s] = _mm256_setzero_si256();
+  }
+  for (; i + 8 <= n; i += 8) {
+    const auto day = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(days + i));
+    const auto inWindow = _mm256_and_si256(_mm256_cmpgt_epi32(day, after),
+                                           _mm256_cmpgt_epi32(before, day));
+    const auto quantity = _mm256_and_si256(
+        inWindow, _mm256_loadu_si256(
+                      reinterpret_cast<const __m256i *>(quantities + i)));
+    const auto status = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(statuses + i)));
+    for (std::size_t s = 0; s < kOrderStatusCount; ++s) {
+      const auto v =
+          _mm256_and_si256(quantity, _mm256_cmpeq_epi32(status, codes[s]));
+      lanes[s] = _mm256_add_epi64(
+          lanes[s], _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+      lanes[s] = _mm256_add_epi64(
+          lanes[s], _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+  }
+  for (std::size_t s = 0; s < kOrderStatusCount; ++s) {
+    alignas(32) std::array<long long, 4> parts;
+    _mm256_store_si256(reinterpret_cast<__m256i *>(parts.data()), lanes[s]);
+    sums[s] += parts[0] + parts[1] + parts[2] + parts[3];
+  }
+#endif
+  // Branch-free, so the compiler can vectorize it for the baseline ISA.
+  for (; i < n; ++i) {
+    const bool inWindow = (days[i] > window.after) & (days[i] < window.before);
+    const long long quantity = inWindow ? quantities[i] : 0;
+    for (std::size_t s = 0; s < kOrderStatusCount; ++s) {
+      sums[s] += statuses[i] == s ? quantity : 0;
+    }
+  }
+
+  for (std::size_t s = 0; s < kOrderStatusCount; ++s) {
+    out[s] += sums[s];
+  }
+}
+
+struct ProductTotals {
+  std::vector<long long> orders;
+  std::vector<long long> quantity;
+};
+
+void addProducts(const qint32 *days, const quint32 *products,
+                 const qint32 *quantities, std::size_t n, DayWindow window,
+                 ProductTotals &out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const long long inWindow =
+        (days[i] > window.after) & (days[i] < window.before);
+    out.orders[products[i]] += inWindow;
+    out.quantity[products[i]] += inWindow * quantities[i];
+  }
+}
+} // namespace
+
+std::optional<OrderSnapshot> OrderSnapshot::load(Database &db) {
+  TRACE_SCOPE("OrderSnapshot::load", "analytics");
+  OrderSnapshot snapshot;
+  const OrderQuery all;
+  if (const auto rows = db.countOrders(all)) {
+    const auto n = static_cast<std::size_t>(*rows);
+    snapshot.days.reserve(n);
+    snapshot.statuses.reserve(n);
+    snapshot.quantities.reserve(n);
+    snapshot.customers.reserve(n);
+    snapshot.products.reserve(n);
+  }
+
+  const auto ok = db.forEachOrder(all, [&](const OrderRow &row) {
+    snapshot.append(row);
+    return true;
+  });
+  if (!ok) {
+    return std::nullopt;
+  }
+  return snapshot;
+}
+
+void OrderSnapshot::append(const OrderRow &row) {
+  days.push_back(row.orderDate.isValid()
+                     ? static_cast<qint32>(row.orderDate.toJulianDay())
+                     : CompactOrder::kNoDate);
+  statuses.push_back(static_cast<quint8>(row.status));
+  quantities.push_back(row.quantity);
+  customers.push_back(customerNames.intern(row.customer));
+  products.push_back(productNames.intern(row.product));
+}
+
+StatusQuantities OrderSnapshot::quantityByStatus(const QDate &from,
+                                                 const QDate &to,
+                                                 int threads) const {
+  TRACE_SCOPE("OrderSnapshot::quantityByStatus", "analytics");
+  const auto window = dayWindow(from, to);
+  const auto workers = workerCount(threads, size());
+
+  std::vector<StatusQuantities> partial(static_cast<std::size_t>(workers),
+                                        StatusQuantities{});
+  forEachChunk(size(), workers,
+               [&](int worker, std::size_t begin, std::size_t end) {
+                 addQuantities(days.data() + begin, statuses.data() + begin,
+                               quantities.data() + begin, end - begin,
+                               window, partial[worker]);
+               });
+
+  StatusQuantities total{};
+  for (const auto &p : partial) {
+    for (std::size_t s = 0; s < kOrderStatusCount; ++s) {
+      total[s] += p[s];
+    }
+  }
+  return total;
+}
+
+std::vector<ProductQuantity> OrderSnapshot::topProducts(const QDate &from,
+                                                        const QDate &to,
+                                                        int limit,
+                                                        int threads) const {
+  TRACE_SCOPE("OrderSnapshot::topProducts", "analytics");
+  const auto window = dayWindow(from, to);
+  const auto workers = workerCount(threads, size());
+  const auto productCount = productNames.size();
+
+  std::vector<ProductTotals> partial(static_cast<std::size_t>(workers));
+  for (auto &p : partial) {
+    p.orders.assign(productCount, 0);
+    p.quantity.assign(productCount, 0);
+  }
+  forEachChunk(size(), workers,
+               [&](int worker, std::size_t begin, std::size_t end) {
+                 addProducts(days.data() + begin, products.data() + begin,
+                             quantities.data() + begin, end - begin, window,
+                             partial[worker]);
+               });
+
+  std::vector<ProductQuantity> out;
+  for (std::size_t id = 0; id < productCount; ++id) {
+    ProductQuantity total;
+    for (const auto &p : partial) {
+      total.orders += p.orders[id];
+      total.quantity += p.quantity[id];
+    }
+    if (total.orders > 0) {
+      total.product = productNames.at(static_cast<quint32>(id));
+      out.push_back(std::move(total));
+    }
+  }
+
+  const auto top = std::min(out.size(),
+                            static_cast<std::size_t>(std::max(limit, 0)));
+  std::partial_sort(out.begin(), out.begin() + top, out.end(),
+                    [](const ProductQuantity &a, const ProductQuantity &b) {
+                      return a.quantity != b.quantity
+                                 ? a.quantity > b.quantity
+                                 : a.product < b.product;
+                    });
+  out.resize(top);
+  return out;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QDate>
+#include <QString>
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "database.h"
+#include "models.h"
+#include "order_store.h"
+
+inline constexpr std::size_t kOrderStatusCount =
+    static_cast<std::size_t>(OrderStatus::Cancelled) + 1;
+
+// Quantity summed per OrderStatus value.
+using StatusQuantities = std::array<long long, kOrderStatusCount>;
+
+struct ProductQuantity {
+  QString product;
+  long long orders = 0;
+  long long quantity = 0;
+};
+
+// Read-only, column-wise copy of the orders table for ad-hoc analytics.
+// Each column is one contiguous array, so a filter over dates and an
+// aggregate over quantities touch only the bytes they need and run as
+// SIMD loops. Queries split the rows into chunks handed out to `threads`
+// workers (0: one per core); rows without a date never match a window.
+class OrderSnapshot final {
+public:
+  // Copies every order; nullopt with db.lastError() set on failure.
+  static std::optional<OrderSnapshot> load(Database &db);
+
+  void append(const OrderRow &row);
+  std::size_t size() const { return days.size(); }
+
+  // Quantities of the orders dated in [from, to), per status.
+  StatusQuantities quantityByStatus(const QDate &from, const QDate &to,
+                                    int threads = 0) const;
+  // Products with the largest total quantity in [from, to), largest first.
+  std::vector<ProductQuantity> topProducts(const QDate &from, const QDate &to,
+                                           int limit, int threads = 0) const;
+
+private:
+  std::vector<qint32> days; // Julian day, CompactOrder::kNoDate if unset
+  std::vector<quint8> statuses;
+  std::vector<qint32> quantities;
+  std::vector<quint32> customers;
+  std::vector<quint32> products;
+  StringDictionary customerNames;
+  StringDictionary productNames;
+};
@@ -0,0 +1,69 @@
+#include "order_store.h"
+
+static_assert(sizeof(CompactOrder) == 32);
+
+quint32 StringDictionary::intern(const QString &value) {
+  if (auto it = ids.constFind(value); it != ids.cend()) {
+    return it.value();
+  }
+  const auto id = static_cast<quint32>(values.size());
+  values.push_back(value);
+  ids.insert(value, id);
+  return id;
+}
+
+void StringDictionary::clear() {
+  values.clear();
+  ids.clear();
+}
+
+CompactOrder OrderStore::encode(const OrderRow &row) {
+  CompactOrder o;
+  o.id = row.id;
+  o.customer = customers.intern(row.customer);
+  o.product = products.intern(row.product);
+  o.quantity = row.quantity;
+  o.orderDay = row.orderDate.isValid()
+                   ? static_cast<qint32>(row.orderDate.toJulianDay())
+                   : CompactOrder::kNoDate;
+  o.status = row.status;
+  return o;
+}
+
+CompactOrder OrderStore::adopt(const CompactOrder &order,
+                               const OrderStore &from) {
+  auto o = order;
+  o.customer = customers.intern(from.customer(order));
+  o.product = products.intern(from.product(order));
+  return o;
+}
+
+OrderRow OrderStore::decode(const CompactOrder &o) const {
+  OrderRow r;
+  r.id = o.id;
+  r.customer = customer(o);
+  r.product = product(o);
+  r.quantity = o.quantity;
+  r.status = o.status;
+  r.orderDate = orderDate(o);
+  return r;
+}
+
+QDate OrderStore::orderDate(const CompactOrder &o) const {
+  return o.orderDay == CompactOrder::kNoDate ? QDate()
+                                             : QDate::fromJulianDay(o.orderDay);
+}
+
+const QString &OrderStore::orderDateText(const CompactOrder &o) const {
+  auto [it, inserted] = dateTexts.try_emplace(o.orderDay);
+  if (inserted) {
+    it->second = orderDate(o).toString(Qt::ISODate);
+  }
+  return it->second;
+}
+
+void OrderStore::clear() {
+  customers.clear();
+  products.clear();
+  dateTexts.clear();
+}
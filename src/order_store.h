@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "database.h"
+#include "models.h"
+
+// Distinct values of one text column, each stored once. Ids are dense and
+// handed out in first-seen order.
+class StringDictionary final {
+public:
+  quint32 intern(const QString &value);
+  const QString &at(quint32 id) const { return values[id]; }
+  std::size_t size() const { return values.size(); }
+  void clear();
+
+private:
+  std::vector<QString> values;
+  QHash<QString, quint32> ids;
+};
+
+// Fixed-width order record. Customer and product are ids into an
+// OrderStore's dictionaries and the date is a Julian day number, so a row
+// owns no heap memory.
+struct CompactOrder {
+  static constexpr qint32 kNoDate = std::numeric_limits<qint32>::min();
+
+  long long id = 0;
+  quint32 customer = 0;
+  quint32 product = 0;
+  qint32 quantity = 0;
+  qint32 orderDay = kNoDate;
+  OrderStatus status = OrderStatus::Pending;
+};
+
+// Dictionaries shared by a set of CompactOrders. Readers get references to
+// the interned strings, so looking up a cell never builds a new QString.
+// Not thread-safe; it belongs to whoever owns the rows.
+class OrderStore final {
+public:
+  CompactOrder encode(const OrderRow &row);
+  OrderRow decode(const CompactOrder &order) const;
+  // `order`, encoded by `from`, re-encoded against this store. Moving the
+  // live rows into a fresh store drops strings no row uses any more.
+  CompactOrder adopt(const CompactOrder &order, const OrderStore &from);
+  // Interned customer and product strings.
+  std::size_t size() const { return customers.size() + products.size(); }
+
+  const QString &customer(const CompactOrder &o) const {
+    return customers.at(o.customer);
+  }
+  const QString &product(const CompactOrder &o) const {
+    return products.at(o.product);
+  }
+  const QString &status(const CompactOrder &o) const {
+    return orderStatusName(o.status);
+  }
+  QDate orderDate(const CompactOrder &o) const;
+  // ISO text of the order date, formatted once per distinct day.
+  const QString &orderDateText(const CompactOrder &o) const;
+
+  // Invalidates every CompactOrder encoded so far.
+  void clear();
+
+private:
+  StringDictionary customers;
+  StringDictionary products;
+  mutable std::unordered_map<qint32, QString> dateTexts;
+};
@@ -0,0 +1,816 @@
+#include "orders_table_model.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+
+#include "query_log.h"
+#include "trace.h"
+
+namespace {
+// Where a changed order sits in a query's ordering, if it matches it.
+
+// Row count of a query, and the changelog position it reflects.
+struct CountAt {
+  std::optional<long long> rows;
+  long long seq = 0;
+};
+
+// Call inside a ReadSnapshot: both reads must see the same commit, or a
+// change landing in between would be counted and then applied again.
+CountAt countAt(Database &d, const OrderQuery &q) {
+  CountAt c;
+  if (const auto seq = d.latestChange()) {
+    c.seq = *seq;
+    c.rows = d.countOrders(q);
+  }
+  return c;
+}
+
+CountAt countInSnapshot(Database &d, const OrderQuery &q) {
+  ReadSnapshot snapshot(d);
+  return snapshot ? countAt(d, q) : CountAt{};
+}
+
+// One change per order, in order of first appearance: an insert followed
+// by updates is still an insert, and an order inserted and deleted since
+// the last sync was never shown, so it needs nothing.
+std::vector<OrderChange> collapseChanges(const std::vector<OrderChange> &in) {
+  using Kind = OrderChange::Kind;
+  std::vector<std::optional<OrderChange>> slots;
+  std::unordered_map<long long, std::size_t> slotOf;
+  for (const auto &c : in) {
+    const auto [it, added] = slotOf.try_emplace(c.id, slots.size());
+    if (added) {
+      slots.push_back(c);
+      continue;
+    }
+    auto &slot = slots[it->second];
+    if (!slot) {
+      slot = c;
+    } else if (slot->kind == Kind::Inserted) {
+      if (c.kind == Kind::Deleted) {
+        slot.reset();
+      }
+    } else {
+      slot->kind = c.kind == Kind::Inserted ? Kind::Updated : c.kind;
+    }
+  }
+
+  std::vector<OrderChange> out;
+  for (const auto &slot : slots) {
+    if (slot) {
+      out.push_back(*slot);
+    }
+  }
+  return out;
+}
+} // namespace
+
+OrdersTableModel::OrdersTableModel(ConnectionPool *pool_,
+                                   AsyncDatabase *searchDb_, QObject *parent)
+    : QAbstractTableModel(parent), pool(pool_), searchDb(searchDb_) {}
+
+int OrdersTableModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : totalRows;
+}
+
+int OrdersTableModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant OrdersTableModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+    return {};
+  }
+
+  const auto *r = rowAt(index.row());
+  if (!r) {
+    return {};
+  }
+
+  switch (index.column()) {
+  case IdColumn:
+    return r->id;
+  case CustomerColumn:
+    return store.customer(*r);
+  case ProductColumn:
+    return store.product(*r);
+  case QuantityColumn:
+    return r->quantity;
+  case StatusColumn:
+    return store.status(*r);
+  case DateColumn:
+    return store.orderDateText(*r);
+  default:
+    return {};
+  }
+}
+
+QVariant OrdersTableModel::headerData(int section, Qt::Orientation orientation,
+                                      int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+    return QAbstractTableModel::headerData(section, orientation, role);
+  }
+
+  switch (section) {
+  case IdColumn:
+    return "ID";
+  case CustomerColumn:
+    return "Customer";
+  case ProductColumn:
+    return "Product";
+  case QuantityColumn:
+    return "Qty";
+  case StatusColumn:
+    return "Status";
+  case DateColumn:
+    return "Date";
+  default:
+    return {};
+  }
+}
+
+void OrdersTableModel::setFilter(const QString &filter) {
+  query.filter = filter;
+}
+
+void OrdersTableModel::setSort(int column, Qt::SortOrder order) {
+  query.sortColumn = column;
+  query.sortOrder = order;
+}
+
+void OrdersTableModel::select() {
+  TRACE_SCOPE("OrdersTableModel::select", "ui");
+  // The previous select's count may still be scanning for a filter
+  // nobody wants any more. Its connection runs nothing else, so the
+  // interrupt cannot hit unrelated work.
+  const bool counting = generation != loadedGeneration;
+  const auto gen = ++generation;
+  latestSelect->store(gen);
+  if (counting && searchDb) {
+    searchDb->interrupt();
+  }
+
+  const auto requested = query;
+  QElapsedTimer started;
+  started.start();
+  Tracer::asyncBegin("select: count to reset", "select", gen);
+
+  auto count = [requested, gen, latest = latestSelect](Database &d) {
+    if (latest->load() != gen) {
+      return CountAt{}; // superseded while queued
+    }
+    return countInSnapshot(d, requested);
+  };
+  auto &counter = searchDb ? *searchDb : pool->reader();
+  counter.run(std::move(count)).then(
+      this,
+      [this, gen, requested, started](DbResult<CountAt> r) {
+        Tracer::asyncEnd("select: count to reset", "select", gen);
+        if (gen != generation) {
+          return;
+        }
+
+        TRACE_SCOPE("OrdersTableModel reset", "ui");
+        beginResetModel();
+
+        pages.clear();
+        pendingPages.clear();
+        cursors.clear();
+        store.clear();
+        activeQuery = requested;
+        loadedGeneration = gen;
+        ++pageEpoch;
+        totalRows = r.value.rows ? static_cast<int>(*r.value.rows) : 0;
+        syncedSeq = r.value.seq;
+        lastErr = r.error;
+
+        endResetModel();
+
+        if (!lastErr.isEmpty()) {
+          qWarning().noquote() << "Orders query failed:" << lastErr;
+        }
+        logSelect(requested, started);
+      });
+}
+
+OrdersTableModel::Prefetch OrdersTableModel::prefetch(Database &db,
+                                                      const OrderQuery &q) {
+  TRACE_SCOPE("OrdersTableModel::prefetch", "db");
+  Prefetch p;
+  p.query = q;
+  ReadSnapshot snapshot(db);
+  if (!snapshot) {
+    return p;
+  }
+  const auto count = countAt(db, q);
+  if (count.rows) {
+    p.lastChange = count.seq;
+    p.totalRows = *count.rows;
+    p.firstPage = db.listOrdersPage(q, std::nullopt, 0, kPageSize);
+  }
+  return p;
+}
+
+void OrdersTableModel::adoptPrefetch(Prefetch p) {
+  TRACE_SCOPE("OrdersTableModel::adoptPrefetch", "ui");
+  beginResetModel();
+
+  pages.clear();
+  pendingPages.clear();
+  cursors.clear();
+  store.clear();
+  query = p.query;
+  activeQuery = p.query;
+  loadedGeneration = ++generation;
+  ++pageEpoch;
+  totalRows = static_cast<int>(p.totalRows);
+  syncedSeq = p.lastChange;
+  lastErr.clear();
+
+  endResetModel();
+  storePage(0, std::move(p.firstPage));
+}
+
+void OrdersTableModel::logSelect(const OrderQuery &q,
+                                 const QElapsedTimer &started) const {
+  // Request to reset, including the wait behind other database work.
+  auto &log = QueryLog::instance();
+  const double ms = static_cast<double>(started.nsecsElapsed()) / 1e6;
+  if (!log.shouldLog(ms)) {
+    return;
+  }
+
+  QueryLogEntry entry;
+  entry.connection = "OrdersTableModel::select";
+  entry.sql = QueryLog::normalizeSql(q.filter.isEmpty() ? "(all orders)"
+                                                        : q.filter);
+  entry.ms = ms;
+  entry.rows = totalRows;
+  entry.slow = log.isSlow(ms);
+  log.write(entry);
+}
+
+const CompactOrder *OrdersTableModel::rowAt(int row) const {
+  if (row < 0 || row >= totalRows) {
+    return nullptr;
+  }
+
+  const int page = row / kPageSize;
+  auto it = pages.find(page);
+  if (it == pages.end()) {
+    requestPage(page);
+    return nullptr;
+  }
+  it->second.lastUsed = ++useCounter;
+
+  const auto offset = static_cast<std::size_t>(row % kPageSize);
+  const auto &rows = it->second.rows;
+  return offset < rows.size() ? &rows[offset] : nullptr;
+}
+
+void OrdersTableModel::requestPage(int page) const {
+  if (pendingPages.contains(page)) {
+    return;
+  }
+
+  const long long firstRow = static_cast<long long>(page) * kPageSize;
+  const int pageRows =
+      static_cast<int>(std::min<long long>(kPageSize, totalRows - firstRow));
+  if (pageRows <= 0) {
+    return;
+  }
+
+  auto [after, skip] = seekTo(firstRow);
+
+  // Jumps towards the end of a large table (dragging the scrollbar down)
+  // are cheaper to read backwards from the last row.
+  const long long skipFromEnd = totalRows - firstRow - pageRows;
+  const bool backwards = skip > 0 && skipFromEnd < skip;
+
+  auto q = activeQuery;
+  if (backwards) {
+    q.sortOrder = q.sortOrder == Qt::AscendingOrder ? Qt::DescendingOrder
+                                                    : Qt::AscendingOrder;
+    after.reset();
+    skip = skipFromEnd;
+  }
+
+  pendingPages.insert(page);
+
+  auto *self = const_cast<OrdersTableModel *>(this);
+  const auto epoch = pageEpoch;
+  const auto span = ++pageSpans;
+  Tracer::asyncBegin("load page", "page", span);
+  pool->listOrdersPage(q, after, skip, pageRows)
+      .then(self, [self, epoch, page, backwards,
+                   span](DbResult<std::vector<OrderRow>> r) {
+        Tracer::asyncEnd("load page", "page", span);
+        if (epoch != self->pageEpoch) {
+          return;
+        }
+        // A failed page stays marked pending so repaints do not retry it in
+        // a loop; the next select() starts over.
+        if (!r.error.isEmpty()) {
+          qWarning().noquote() << "Failed to load orders page:" << r.error;
+          return;
+        }
+        self->pendingPages.erase(page);
+        if (backwards) {
+          std::reverse(r.value.begin(), r.value.end());
+        }
+        self->storePage(page, std::move(r.value));
+      });
+}
+
+std::pair<std::optional<OrderCursor>, long long>
+OrdersTableModel::seekTo(long long row) const {
+  // Seek from the nearest known cursor at or before this row; only the
+  // distance past that cursor has to be skipped.
+  const auto page = static_cast<int>(row / kPageSize);
+  if (auto it = cursors.upper_bound(page); it != cursors.begin()) {
+    --it;
+    return {it->second, row - static_cast<long long>(it->first) * kPageSize};
+  }
+  return {std::nullopt, row};
+}
+
+QFuture<DbResult<std::vector<long long>>>
+OrdersTableModel::orderIds(const std::vector<RowRange> &ranges) const {
+  struct Read {
+    std::optional<OrderCursor> after;
+    long long skip = 0;
+    int rows = 0;
+    int end = 0; // first row past the run
+  };
+  std::vector<long long> ids;
+  std::vector<Read> reads;
+
+  for (const auto &range : ranges) {
+    const int last = std::min(range.last, totalRows - 1);
+    for (int row = std::max(range.first, 0); row <= last;) {
+      const int page = row / kPageSize;
+      const int pageLast = std::min(last, (page + 1) * kPageSize - 1);
+      const auto it = pages.find(page);
+      const auto offset = static_cast<std::size_t>(pageLast % kPageSize);
+      if (it != pages.end() && offset < it->second.rows.size()) {
+        for (int r = row; r <= pageLast; ++r) {
+          ids.push_back(
+              it->second.rows[static_cast<std::size_t>(r % kPageSize)].id);
+        }
+      } else if (!reads.empty() && reads.back().end == row) {
+        reads.back().rows += pageLast - row + 1;
+        reads.back().end = pageLast + 1;
+      } else {
+        auto [after, skip] = seekTo(row);
+        reads.push_back({after, skip, pageLast - row + 1, pageLast + 1});
+      }
+      row = pageLast + 1;
+    }
+  }
+
+  return pool->read([q = activeQuery, reads = std::move(reads),
+                     ids = std::move(ids)](Database &d) mutable {
+    for (const auto &r : reads) {
+      const auto rows = d.listOrdersPage(q, r.after, r.skip, r.rows);
+      if (!d.lastError().isEmpty()) {
+        break;
+      }
+      for (const auto &o : rows) {
+        ids.push_back(o.id);
+      }
+    }
+    return ids;
+  });
+}
+
+void OrdersTableModel::storePage(int page, std::vector<OrderRow> rows) {
+  TRACE_SCOPE("OrdersTableModel::storePage", "ui");
+  if (rows.empty()) {
+    return;
+  }
+
+  evictPages();
+
+  const int first = page * kPageSize;
+  const int last = first + static_cast<int>(rows.size()) - 1;
+
+  auto &entry = pages[page];
+  entry.rows.clear();
+  entry.rows.reserve(rows.size());
+  for (const auto &r : rows) {
+    entry.rows.push_back(store.encode(r));
+  }
+  entry.lastUsed = ++useCounter;
+  cursors[page + 1] = cursorAfter(entry.rows.back());
+
+  emit dataChanged(index(first, 0), index(last, ColumnCount - 1));
+}
+
+void OrdersTableModel::refresh() {
+  const auto gen = generation;
+
+  pool->read([q = activeQuery](Database &d) {
+        return countInSnapshot(d, q);
+      })
+      .then(this, [this, gen](DbResult<CountAt> r) {
+        if (gen != generation || !r.value.rows) {
+          return;
+        }
+        syncedSeq = r.value.seq;
+
+        ++pageEpoch;
+        pages.clear();
+        pendingPages.clear();
+        cursors.clear();
+        store.clear();
+
+        const int count = static_cast<int>(*r.value.rows);
+        if (count > totalRows) {
+          beginInsertRows({}, totalRows, count - 1);
+          totalRows = count;
+          endInsertRows();
+        } else if (count < totalRows) {
+          beginRemoveRows({}, count, totalRows - 1);
+          totalRows = count;
+          endRemoveRows();
+        }
+
+        if (totalRows > 0) {
+          emit dataChanged(index(0, 0), index(totalRows - 1, ColumnCount - 1));
+        }
+      });
+}
+
+void OrdersTableModel::applyChanges(std::vector<OrderChange> changes,
+                                    quint64 gen) {
+  std::vector<long long> ids;
+  for (const auto &c : changes) {
+    if (c.kind != OrderChange::Kind::Deleted) {
+      ids.push_back(c.id);
+    }
+  }
+
+  const auto epoch = pageEpoch;
+  pool->read([q = activeQuery, ids](Database &d) {
+        return d.matchingOrders(q, ids);
+      })
+      .then(this, [this, gen, epoch, changes = std::move(changes)](
+                      DbResult<std::vector<OrderRow>> r) {
+        if (gen != loadedGeneration || epoch != pageEpoch) {
+          // A refresh() landed in between and already counted these rows;
+          // placing them again would add them twice. Read on from the
+          // position it set.
+          syncAgain = true;
+        } else if (!r.error.isEmpty()) {
+          refresh();
+        } else {
+          std::unordered_map<long long, OrderRow> rows;
+          for (auto &row : r.value) {
+            rows.emplace(row.id, std::move(row));
+          }
+          // Each order is placed against the rows as they are by then, so
+          // the changes can go in any order.
+          for (const auto &c : changes) {
+            const auto it = rows.find(c.id);
+            const auto order = it == rows.end()
+                                   ? std::optional<OrderRow>()
+                                   : std::optional(it->second);
+            if (!placeOrder(c.id, order)) {
+              refresh();
+              break;
+            }
+          }
+        }
+        finishSync(gen);
+      });
+}
+
+bool OrdersTableModel::placeOrder(long long orderId,
+                                  const std::optional<OrderRow> &order) {
+  const auto current = cachedRowOf(orderId);
+  std::optional<CompactOrder> encoded;
+  if (order) {
+    encoded = store.encode(*order);
+  }
+
+  // The usual edit leaves the sort value alone, and so the row in place.
+  if (current && encoded) {
+    auto &slot = pages[*current / kPageSize].rows[*current % kPageSize];
+    if (cursorAfter(slot).sortValue == cursorAfter(*encoded).sortValue) {
+      slot = *encoded;
+      emit dataChanged(index(*current, 0), index(*current, ColumnCount - 1));
+      return true;
+    }
+  }
+
+  if (current) {
+    removeRowAt(*current);
+  }
+  if (!encoded) {
+    return true;
+  }
+  const auto row = cachedPositionOf(cursorAfter(*encoded));
+  if (!row) {
+    return false;
+  }
+  insertRowAt(*row, *order);
+  return true;
+}
+
+std::optional<int>
+OrdersTableModel::cachedPositionOf(const OrderCursor &key) const {
+  std::vector<int> keys;
+  for (const auto &[k, entry] : pages) {
+    keys.push_back(k);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  for (int k : keys) {
+    const auto &rows = pages.at(k).rows;
+    if (rows.empty()) {
+      continue;
+    }
+    const int first = k * kPageSize;
+    const int size = static_cast<int>(rows.size());
+    const int at = static_cast<int>(
+        std::partition_point(rows.begin(), rows.end(),
+                             [&](const CompactOrder &r) {
+                               return sortsBefore(cursorAfter(r), key);
+                             }) -
+        rows.begin());
+
+    if (at > 0 && at < size) {
+      return first + at;
+    }
+    // On a page boundary: known only if the row before it is cached too,
+    // or there is none.
+    if (at == 0) {
+      if (k == 0) {
+        return 0;
+      }
+      if (auto prev = pages.find(k - 1);
+          prev != pages.end() && !prev->second.rows.empty() &&
+          sortsBefore(cursorAfter(prev->second.rows.back()), key)) {
+        return first;
+      }
+    }
+    if (at == size && first + size == totalRows) {
+      return totalRows;
+    }
+  }
+  return std::nullopt;
+}
+
+bool OrdersTableModel::sortsBefore(const OrderCursor &a,
+                                   const OrderCursor &b) const {
+  // As selectOrdersSql orders rows: sort value, then id, both in the
+  // query's direction. Text compares as UTF-8 bytes, like SQLite's BINARY
+  // collation.
+  int cmp = 0;
+  if (a.sortValue.typeId() == QMetaType::QString) {
+    const auto x = a.sortValue.toString().toUtf8();
+    const auto y = b.sortValue.toString().toUtf8();
+    cmp = x < y ? -1 : y < x ? 1 : 0;
+  } else if (a.sortValue.isValid()) {
+    const auto x = a.sortValue.toLongLong();
+    const auto y = b.sortValue.toLongLong();
+    cmp = x < y ? -1 : y < x ? 1 : 0;
+  }
+  if (cmp == 0) {
+    cmp = a.id < b.id ? -1 : b.id < a.id ? 1 : 0;
+  }
+  return activeQuery.sortOrder == Qt::DescendingOrder ? cmp > 0 : cmp < 0;
+}
+
+void OrdersTableModel::syncChanges() {
+  // Nothing shown yet: the pending select() will see every change.
+  if (loadedGeneration == 0) {
+    return;
+  }
+  if (syncing) {
+    syncAgain = true;
+    return;
+  }
+  syncing = true;
+
+  const auto gen = loadedGeneration;
+  pool->read([since = syncedSeq](Database &d) {
+        return d.changesSince(since, kMaxSyncChanges);
+      })
+      .then(this, [this, gen](DbResult<std::optional<ChangeFeed>> r) {
+        if (!r.value) {
+          qWarning().noquote() << "Failed to read order changes:" << r.error;
+          finishSync(gen);
+          return;
+        }
+        if (gen != loadedGeneration) {
+          finishSync(gen);
+          return;
+        }
+
+        const auto &feed = *r.value;
+        syncedSeq = feed.lastSeq;
+        auto changes = collapseChanges(feed.changes);
+        // An update or delete of a row that is not cached may shift any
+        // row, so one refresh() covers the whole batch; otherwise the
+        // changes are patched in.
+        const bool patchable =
+            std::ranges::all_of(changes, [this](const OrderChange &c) {
+              return c.kind == OrderChange::Kind::Inserted ||
+                     cachedRowOf(c.id).has_value();
+            });
+        if (!feed.complete || !patchable) {
+          refresh();
+          finishSync(gen);
+          return;
+        }
+        applyChanges(std::move(changes), gen);
+      });
+}
+
+void OrdersTableModel::finishSync(quint64 gen) {
+  syncing = false;
+  // A select() in between reset the rows and the position; read again
+  // from there.
+  if (syncAgain || gen != loadedGeneration) {
+    syncAgain = false;
+    syncChanges();
+  }
+}
+
+std::optional<OrderRow>
+OrdersTableModel::cachedOrder(long long orderId) const {
+  const auto row = cachedRowOf(orderId);
+  if (!row) {
+    return std::nullopt;
+  }
+  return store.decode(pages.at(*row / kPageSize).rows[*row % kPageSize]);
+}
+
+std::optional<int> OrdersTableModel::cachedRowOf(long long orderId) const {
+  for (const auto &[page, entry] : pages) {
+    for (std::size_t i = 0; i < entry.rows.size(); ++i) {
+      if (entry.rows[i].id == orderId) {
+        return page * kPageSize + static_cast<int>(i);
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+void OrdersTableModel::removeRowAt(int row) {
+  const int first = row / kPageSize;
+
+  beginRemoveRows({}, row, row);
+
+  // Every cached page from here on moves up by one row: page k drops its
+  // first row (or the removed one) and pulls in the first row of k + 1.
+  std::vector<int> keys;
+  for (const auto &[k, entry] : pages) {
+    if (k >= first) {
+      keys.push_back(k);
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+
+  for (int k : keys) {
+    auto &rows = pages[k].rows;
+    const auto at = k == first ? static_cast<std::size_t>(row % kPageSize) : 0;
+    if (at < rows.size()) {
+      rows.erase(rows.begin() + static_cast<std::ptrdiff_t>(at));
+    }
+    if (auto next = pages.find(k + 1);
+        next != pages.end() && !next->second.rows.empty()) {
+      rows.push_back(next->second.rows.front());
+    }
+  }
+
+  --totalRows;
+  settlePages(first);
+
+  endRemoveRows();
+}
+
+void OrdersTableModel::insertRowAt(int row, const OrderRow &order) {
+  row = std::clamp(row, 0, totalRows);
+  const int first = row / kPageSize;
+
+  beginInsertRows({}, row, row);
+
+  // Every cached page from here on moves down by one row: the last row of
+  // page k becomes the first row of k + 1.
+  std::vector<int> keys;
+  for (const auto &[k, entry] : pages) {
+    if (k >= first) {
+      keys.push_back(k);
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+
+  const auto encoded = store.encode(order);
+  std::optional<CompactOrder> carry;
+  int carryFrom = -1;
+  for (int k : keys) {
+    auto &rows = pages[k].rows;
+    const auto at = static_cast<std::size_t>(row % kPageSize);
+
+    if (k == first && at <= rows.size()) {
+      rows.insert(rows.begin() + static_cast<std::ptrdiff_t>(at), encoded);
+    } else if (k != first && carry && carryFrom == k - 1) {
+      rows.insert(rows.begin(), *carry);
+    } else {
+      rows.clear(); // first row unknown; settlePages() drops it
+    }
+
+    carry.reset();
+    if (rows.size() > static_cast<std::size_t>(kPageSize)) {
+      carry = rows.back();
+      carryFrom = k;
+      rows.pop_back();
+    }
+  }
+
+  ++totalRows;
+  settlePages(first);
+
+  endInsertRows();
+}
+
+void OrdersTableModel::settlePages(int fromPage) {
+  // In-flight fetches were computed against the old row positions.
+  ++pageEpoch;
+  pendingPages.clear();
+
+  // Drop pages that could not be patched exactly, and re-derive the keyset
+  // cursors past the change from the pages that are left.
+  cursors.erase(cursors.upper_bound(fromPage), cursors.end());
+  for (auto it = pages.begin(); it != pages.end();) {
+    const int k = it->first;
+    const auto expected = static_cast<std::size_t>(std::clamp(
+        totalRows - k * kPageSize, 0, kPageSize));
+    if (k < fromPage) {
+      ++it;
+    } else if (expected == 0 || it->second.rows.size() != expected) {
+      it = pages.erase(it);
+    } else {
+      cursors[k + 1] = cursorAfter(it->second.rows.back());
+      ++it;
+    }
+  }
+}
+
+void OrdersTableModel::evictPages() {
+  // Pages the view stopped asking for are the least recently used ones.
+  while (pages.size() >= kMaxCachedPages) {
+    auto oldest = std::min_element(
+        pages.begin(), pages.end(), [](const auto &a, const auto &b) {
+          return a.second.lastUsed < b.second.lastUsed;
+        });
+    pages.erase(oldest);
+  }
+
+  // Evicted rows leave their strings behind. The cached rows use at most
+  // two strings each, so rebuilding at twice that keeps the dictionaries
+  // bounded and costs O(1) per string interned since the last rebuild.
+  constexpr auto kMaxStrings =
+      4 * kMaxCachedPages * static_cast<std::size_t>(kPageSize);
+  if (store.size() <= kMaxStrings) {
+    return;
+  }
+  OrderStore compacted;
+  for (auto &[page, entry] : pages) {
+    for (auto &row : entry.rows) {
+      row = compacted.adopt(row, store);
+    }
+  }
+  store = std::move(compacted);
+}
+
+OrderCursor OrdersTableModel::cursorAfter(const CompactOrder &row) const {
+  OrderCursor c;
+  c.id = row.id;
+
+  switch (activeQuery.sortColumn) {
+  case CustomerColumn:
+    c.sortValue = store.customer(row);
+    break;
+  case ProductColumn:
+    c.sortValue = store.product(row);
+    break;
+  case QuantityColumn:
+    c.sortValue = row.quantity;
+    break;
+  case StatusColumn:
+    c.sortValue = static_cast<int>(row.status);
+    break;
+  case DateColumn:
+    c.sortValue = row.orderDay;
+    break;
+  default:
+    break;
+  }
+
+  return c;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QElapsedTimer>
+#include <QString>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "async_database.h"
+#include "connection_pool.h"
+#include "database.h"
+#include "order_store.h"
+
+// Read-only view over the orders table that only materializes the pages the
+// view asks for. Pages are fetched with keyset queries on the pool's
+// readers and kept in a small LRU cache, so memory stays flat no matter how
+// many orders exist. Cached rows are dictionary-encoded CompactOrders.
+// Cells of a page still in flight read as empty until the page arrives.
+class OrdersTableModel final : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  enum Column {
+    IdColumn,
+    CustomerColumn,
+    ProductColumn,
+    QuantityColumn,
+    StatusColumn,
+    DateColumn,
+    ColumnCount
+  };
+
+  // select() counts rows on `searchDb` if given, a connection of its own
+  // so a superseded count can be interrupted without touching other work;
+  // otherwise on one of `pool`'s readers.
+  explicit OrdersTableModel(ConnectionPool *pool,
+                            AsyncDatabase *searchDb = nullptr,
+                            QObject *parent = nullptr);
+
+  // The row count and first page of a query, read ahead of time on any
+  // connection (the caller's thread) and shown later by adoptPrefetch().
+  struct Prefetch {
+    OrderQuery query;
+    long long lastChange = 0; // changelog position the rows reflect
+    long long totalRows = 0;
+    std::vector<OrderRow> firstPage;
+  };
+  static Prefetch prefetch(Database &db, const OrderQuery &query);
+  // Shows `p` as the result of its query without querying again.
+  void adoptPrefetch(Prefetch p);
+
+  int rowCount(const QModelIndex &parent = {}) const override;
+  int columnCount(const QModelIndex &parent = {}) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+  void setFilter(const QString &filter);
+  void setSort(int column, Qt::SortOrder order);
+  // Re-runs the query in the background; the model resets once the new
+  // row count is known. A select() that is still counting when the next
+  // one starts is interrupted, or skipped if it has not started yet.
+  void select();
+  // Re-counts and re-reads rows in place, keeping the view's scroll
+  // position and selection.
+  void refresh();
+  // Reads orders_changelog past the last position seen and applies those
+  // changes, whichever process made them; refreshes instead when there
+  // are too many or the log no longer goes back that far.
+  void syncChanges();
+
+  // Filter and sort of the rows currently shown.
+  const OrderQuery &currentQuery() const { return activeQuery; }
+  // True when the shown rows belong to the pending filter and sort and no
+  // select() is in flight.
+  bool isCurrent() const {
+    return loadedGeneration != 0 && loadedGeneration == generation &&
+           query == activeQuery;
+  }
+  // The order as last read into the page cache, if it is cached.
+  std::optional<OrderRow> cachedOrder(long long orderId) const;
+  // A run of adjacent rows, first to last inclusive.
+  struct RowRange {
+    int first = 0;
+    int last = 0;
+  };
+  // Ids of the orders at `ranges`, e.g. a multi-row selection. Cached
+  // pages answer directly; the rest is read on a reader, one keyset query
+  // per run of uncached rows.
+  QFuture<DbResult<std::vector<long long>>>
+  orderIds(const std::vector<RowRange> &ranges) const;
+  QString lastError() const { return lastErr; }
+
+private:
+  static constexpr int kPageSize = 256;
+  static constexpr std::size_t kMaxCachedPages = 16;
+  // Above this many changes per sync a refresh() is cheaper.
+  static constexpr int kMaxSyncChanges = 256;
+
+  struct Page {
+    std::vector<CompactOrder> rows;
+    quint64 lastUsed = 0;
+  };
+
+  ConnectionPool *pool;
+  AsyncDatabase *searchDb;
+  OrderQuery query;       // edited by setFilter/setSort
+  OrderQuery activeQuery; // the one the current rows belong to
+  int totalRows = 0;
+  QString lastErr;
+
+  // select() bumps `generation`; results of older selects are dropped.
+  quint64 generation = 0;
+  quint64 loadedGeneration = 0;
+  // `generation` as seen from the database thread.
+  std::shared_ptr<std::atomic<quint64>> latestSelect =
+      std::make_shared<std::atomic<quint64>>(0);
+  // Bumped whenever row positions shift; page fetches issued before that
+  // are dropped.
+  quint64 pageEpoch = 0;
+
+  // Changelog position the rows reflect: read before each count, so
+  // changes racing a select are applied again rather than missed.
+  long long syncedSeq = 0;
+  bool syncing = false;
+  bool syncAgain = false; // syncChanges() called while syncing
+
+  // Cache state is touched from data(), which is const.
+  mutable std::unordered_map<int, Page> pages;
+  mutable std::unordered_set<int> pendingPages;
+  // Keyset position just before the first row of a page, learned as pages
+  // are read. Kept after the page itself is evicted: it is only two values.
+  mutable std::map<int, OrderCursor> cursors;
+  mutable quint64 useCounter = 0;
+  mutable quint64 pageSpans = 0; // trace ids for page loads
+  // Dictionaries for every cached row; cleared with the page cache and
+  // compacted as pages are evicted.
+  OrderStore store;
+
+  const CompactOrder *rowAt(int row) const;
+  void requestPage(int page) const;
+  // Keyset cursor and remaining skip to start reading at `row`.
+  std::pair<std::optional<OrderCursor>, long long> seekTo(long long row) const;
+  void storePage(int page, std::vector<OrderRow> rows);
+  std::optional<int> cachedRowOf(long long orderId) const;
+  void removeRowAt(int row);
+  void insertRowAt(int row, const OrderRow &order);
+  // Patches a batch of changes in with one read, instead of re-running the
+  // whole query; falls back to refresh() when an order sorts next to a
+  // page that is not cached. Ends the sync started at `gen`.
+  void applyChanges(std::vector<OrderChange> changes, quint64 gen);
+  void finishSync(quint64 gen);
+  // Moves the cached copy of the order to where `order`, its current state
+  // (nullopt once it is gone or filtered out), sorts among the cached
+  // rows. False if that is outside them and only a refresh() can tell.
+  bool placeOrder(long long orderId, const std::optional<OrderRow> &order);
+  // Row at which `key` would sort, found among the cached pages without
+  // asking the database; nullopt if it falls next to an uncached page.
+  std::optional<int> cachedPositionOf(const OrderCursor &key) const;
+  bool sortsBefore(const OrderCursor &a, const OrderCursor &b) const;
+  void settlePages(int fromPage);
+  void evictPages();
+  OrderCursor cursorAfter(const CompactOrder &row) const;
+  void logSelect(const OrderQuery &q, const QElapsedTimer &started) const;
+};
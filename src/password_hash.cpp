@@ -0,0 +1,124 @@
+#include "password_hash.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr int kKeyBytes = 32;
+constexpr int kCalibrationCost = 20'000;
+
+QString randomSaltHex(int bytes = 16) {
+  QByteArray buf;
+  buf.resize(bytes);
+  for (int i = 0; i < bytes; ++i) {
+    buf[i] = static_cast<char>(QRandomGenerator::global()->generate() & 0xFF);
+  }
+  return QString::fromLatin1(buf.toHex());
+}
+
+QByteArray saltedSha256(const QString &saltHex, const QString &password) {
+  const QByteArray input = (saltHex + ":" + password).toUtf8();
+  return QCryptographicHash::hash(input, QCryptographicHash::Sha256);
+}
+
+// RFC 8018 PBKDF2 with HMAC-SHA256 as the PRF.
+QByteArray pbkdf2Sha256(const QByteArray &password, const QByteArray &salt,
+                        int iterations) {
+  QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+  QByteArray key;
+  for (quint32 block = 1; key.size() < kKeyBytes; ++block) {
+    const char index[4] = {
+        static_cast<char>(block >> 24), static_cast<char>(block >> 16),
+        static_cast<char>(block >> 8), static_cast<char>(block)};
+    mac.reset();
+    mac.addData(salt);
+    mac.addData(index, sizeof index);
+    auto u = mac.result();
+    auto t = u;
+    for (int i = 1; i < iterations; ++i) {
+      mac.reset();
+      mac.addData(u);
+      u = mac.result();
+      for (qsizetype j = 0; j < t.size(); ++j) {
+        t[j] = static_cast<char>(t[j] ^ u[j]);
+      }
+    }
+    key += t;
+  }
+  key.truncate(kKeyBytes);
+  return key;
+}
+
+QByteArray pbkdf2Sha256(const QString &password, const QString &saltHex,
+                        int iterations) {
+  return pbkdf2Sha256(password.toUtf8(),
+                      QByteArray::fromHex(saltHex.toLatin1()), iterations);
+}
+
+bool constantTimeEquals(const QByteArray &a, const QByteArray &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  unsigned char diff = 0;
+  for (qsizetype i = 0; i < a.size(); ++i) {
+    diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+  }
+  return diff == 0;
+}
+} // namespace
+
+PasswordHash hashPassword(const QString &password, int cost) {
+  PasswordHash h;
+  h.algorithm = kPbkdf2Sha256;
+  h.cost = std::max(cost, 1);
+  h.saltHex = randomSaltHex();
+  h.hashHex =
+      QString::fromLatin1(pbkdf2Sha256(password, h.saltHex, h.cost).toHex());
+  return h;
+}
+
+bool verifyPassword(const QString &password, const PasswordHash &stored) {
+  QByteArray computed;
+  if (stored.algorithm == kPbkdf2Sha256 && stored.cost >= 1) {
+    computed = pbkdf2Sha256(password, stored.saltHex, stored.cost);
+  } else if (stored.algorithm == kLegacySha256) {
+    computed = saltedSha256(stored.saltHex, password);
+  } else {
+    return false;
+  }
+  return constantTimeEquals(computed,
+                            QByteArray::fromHex(stored.hashHex.toLatin1()));
+}
+
+bool needsRehash(const PasswordHash &stored, int cost) {
+  return stored.algorithm != kPbkdf2Sha256 ||
+         stored.cost != std::max(cost, 1);
+}
+
+PasswordHash dummyPasswordHash(int cost) {
+  PasswordHash h;
+  h.algorithm = kPbkdf2Sha256;
+  h.cost = std::max(cost, 1);
+  h.saltHex = randomSaltHex();
+  return h; // an empty hashHex compares unequal to every derived key
+}
+
+int calibratePasswordCost(std::chrono::milliseconds target) {
+  const auto salt = QByteArray::fromHex(randomSaltHex().toLatin1());
+  QElapsedTimer timer;
+  timer.start();
+  pbkdf2Sha256(QByteArrayLiteral("calibration"), salt, kCalibrationCost);
+  const auto elapsedNs = std::max<qint64>(timer.nsecsElapsed(), 1);
+
+  const auto cost = std::llround(static_cast<double>(kCalibrationCost) *
+                                 std::chrono::nanoseconds(target).count() /
+                                 static_cast<double>(elapsedNs));
+  return static_cast<int>(std::clamp<long long>(
+      cost, 1, std::numeric_limits<int>::max()));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QString>
+#include <chrono>
+
+// Algorithms stored in users.password_algo.
+inline constexpr auto kLegacySha256 = "sha256"; // one salted SHA-256
+inline constexpr auto kPbkdf2Sha256 = "pbkdf2-sha256";
+
+// PBKDF2 iterations for new hashes unless --password-cost says otherwise
+// (OWASP's figure for PBKDF2-HMAC-SHA256). Use the PasswordCost benchmark
+// to pick one that fits a verification time budget on a given machine.
+inline constexpr int kDefaultPasswordCost = 600'000;
+
+struct PasswordHash {
+  QString algorithm;
+  int cost = 1; // PBKDF2 iterations; 1 for the legacy algorithm
+  QString saltHex;
+  QString hashHex;
+};
+
+// Fresh salt, PBKDF2-HMAC-SHA256 with `cost` iterations.
+PasswordHash hashPassword(const QString &password, int cost);
+// Recomputes with the stored algorithm, salt and cost; compares in
+// constant time.
+bool verifyPassword(const QString &password, const PasswordHash &stored);
+// True if `stored` should be replaced with hashPassword(password, cost)
+// the next time the plain password is at hand.
+bool needsRehash(const PasswordHash &stored, int cost);
+// Stand-in for a user that does not exist: verifying against it costs as
+// much as a real hash of `cost` iterations and never matches.
+PasswordHash dummyPasswordHash(int cost);
+
+// Cost whose hashing takes about `target` on this machine, measured by
+// timing a short run and scaling.
+int calibratePasswordCost(std::chrono::milliseconds target);
@@ -0,0 +1,149 @@
+#include "prefix_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <queue>
+
+namespace {
+QString foldKey(const QString &value) {
+  return value.trimmed().toCaseFolded();
+}
+} // namespace
+
+PrefixIndex::PrefixIndex(const std::vector<ValueFrequency> &input) {
+  std::vector<std::pair<QString, std::size_t>> order;
+  order.reserve(input.size());
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    order.emplace_back(foldKey(input[i].value), i);
+  }
+  std::sort(order.begin(), order.end());
+
+  keys.reserve(order.size());
+  values.reserve(order.size());
+  counts.reserve(order.size());
+  long long shownCount = 0;
+  for (const auto &[key, i] : order) {
+    const auto &v = input[i];
+    if (!keys.empty() && keys.back() == key) {
+      counts.back() += v.orders;
+      if (v.orders > shownCount) {
+        values.back() = v.value.trimmed();
+        shownCount = v.orders;
+      }
+      continue;
+    }
+    keys.push_back(key);
+    values.push_back(v.value.trimmed());
+    counts.push_back(v.orders);
+    shownCount = v.orders;
+  }
+  rebuild();
+}
+
+int PrefixIndex::better(int a, int b) const {
+  if (a < 0) {
+    return b;
+  }
+  if (b < 0) {
+    return a;
+  }
+  // Ties go to the alphabetically first value.
+  return counts[b] > counts[a] ? b : a;
+}
+
+void PrefixIndex::rebuild() {
+  leaves = std::bit_ceil(std::max<std::size_t>(keys.size(), 1));
+  tree.assign(2 * leaves, -1);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    tree[leaves + i] = static_cast<int>(i);
+  }
+  for (std::size_t v = leaves - 1; v >= 1; --v) {
+    tree[v] = better(tree[2 * v], tree[2 * v + 1]);
+  }
+}
+
+void PrefixIndex::updateLeaf(std::size_t i) {
+  for (auto v = (leaves + i) / 2; v >= 1; v /= 2) {
+    tree[v] = better(tree[2 * v], tree[2 * v + 1]);
+  }
+}
+
+void PrefixIndex::add(const QString &value, long long delta) {
+  const auto key = foldKey(value);
+  if (key.isEmpty()) {
+    return;
+  }
+
+  const auto it = std::lower_bound(keys.begin(), keys.end(), key);
+  const auto i = static_cast<std::size_t>(it - keys.begin());
+  if (it != keys.end() && *it == key) {
+    counts[i] += delta;
+    updateLeaf(i);
+    return;
+  }
+  if (delta <= 0) {
+    return;
+  }
+
+  keys.insert(it, key);
+  values.insert(values.begin() + static_cast<std::ptrdiff_t>(i),
+                value.trimmed());
+  counts.insert(counts.begin() + static_cast<std::ptrdiff_t>(i), delta);
+  rebuild();
+}
+
+QStringList PrefixIndex::topMatches(const QString &prefix, int limit) const {
+  QStringList out;
+  const auto key = foldKey(prefix);
+  const auto first = std::lower_bound(keys.begin(), keys.end(), key);
+  const auto last = std::partition_point(
+      first, keys.end(), [&](const QString &k) { return k.startsWith(key); });
+  if (first == last || limit <= 0) {
+    return out;
+  }
+
+  // Max-heap of tree nodes by their best count. Starts with the nodes
+  // that exactly cover [first, last); each pop yields that node's best
+  // value and pushes the rest of the node as the siblings along the path
+  // down to it.
+  const auto worse = [this](std::size_t a, std::size_t b) {
+    const auto ca = counts[static_cast<std::size_t>(tree[a])];
+    const auto cb = counts[static_cast<std::size_t>(tree[b])];
+    return ca != cb ? ca < cb : tree[a] > tree[b];
+  };
+  std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(worse)>
+      heap(worse);
+
+  auto l = leaves + static_cast<std::size_t>(first - keys.begin());
+  auto r = leaves + static_cast<std::size_t>(last - keys.begin());
+  for (; l < r; l /= 2, r /= 2) {
+    if (l & 1) {
+      heap.push(l++);
+    }
+    if (r & 1) {
+      heap.push(--r);
+    }
+  }
+
+  while (!heap.empty() && out.size() < limit) {
+    auto v = heap.top();
+    heap.pop();
+    const auto best = tree[v];
+    if (best < 0 || counts[static_cast<std::size_t>(best)] <= 0) {
+      break;
+    }
+    out << values[static_cast<std::size_t>(best)];
+
+    const auto leaf = leaves + static_cast<std::size_t>(best);
+    while (v < leaves) {
+      const auto child =
+          leaf >> (std::bit_width(leaf) - std::bit_width(v) - 1);
+      if (tree[child ^ 1] >= 0) {
+        heap.push(child ^ 1);
+      }
+      v = child;
+    }
+  }
+  return out;
+}
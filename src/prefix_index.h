@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+#include "database.h"
+
+// Distinct strings with a use count, answering "the most used values that
+// start with this prefix" (case-insensitively) for type-ahead. Values are
+// kept sorted by their case-folded form, so a prefix selects one contiguous
+// range, and a max segment tree over the counts pulls the top N out of that
+// range in O(N log n) without looking at the rest of it.
+class PrefixIndex final {
+public:
+  PrefixIndex() = default;
+  // Values that fold to the same key are merged; the most used spelling is
+  // the one suggested.
+  explicit PrefixIndex(const std::vector<ValueFrequency> &values);
+
+  // Adds `delta` uses of `value` (negative to remove some). Changing a
+  // known value's count is O(log n); a new value is inserted in place and
+  // costs O(n).
+  void add(const QString &value, long long delta = 1);
+  // Up to `limit` values starting with `prefix`, most used first.
+  QStringList topMatches(const QString &prefix, int limit) const;
+  std::size_t size() const { return keys.size(); }
+
+private:
+  std::vector<QString> keys; // case-folded, sorted
+  std::vector<QString> values;
+  std::vector<long long> counts;
+  // Bottom-up tree over `leaves` slots: node v holds the index of the
+  // largest count under it, -1 for empty padding.
+  std::vector<int> tree;
+  std::size_t leaves = 0;
+
+  int better(int a, int b) const;
+  void rebuild();
+  void updateLeaf(std::size_t i);
+};
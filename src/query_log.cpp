@@ -0,0 +1,127 @@
+#include "query_log.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace {
+nlohmann::json toJson(const QStringList &list) {
+  auto out = nlohmann::json::array();
+  for (const auto &s : list) {
+    out.push_back(s.toStdString());
+  }
+  return out;
+}
+} // namespace
+
+QueryLog &QueryLog::instance() {
+  static QueryLog log;
+  return log;
+}
+
+void QueryLog::configure(const Settings &settings) {
+  QMutexLocker lock(&mutex);
+  file.close();
+  config = settings;
+  if (config.path.isEmpty()) {
+    return;
+  }
+
+  QDir().mkpath(QFileInfo(config.path).absolutePath());
+  file.setFileName(config.path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qWarning().noquote() << "Cannot open query log" << config.path << ":"
+                         << file.errorString();
+    config.path.clear();
+  }
+}
+
+bool QueryLog::enabled() const {
+  QMutexLocker lock(&mutex);
+  return !config.path.isEmpty();
+}
+
+bool QueryLog::isSlow(double ms) const {
+  QMutexLocker lock(&mutex);
+  return ms >= config.slowMs;
+}
+
+bool QueryLog::shouldLog(double ms) const {
+  QMutexLocker lock(&mutex);
+  return !config.path.isEmpty() && (config.logAll || ms >= config.slowMs);
+}
+
+void QueryLog::write(const QueryLogEntry &entry) {
+  const nlohmann::ordered_json j = {
+      {"time", QDateTime::currentDateTimeUtc()
+                   .toString(Qt::ISODateWithMs)
+                   .toStdString()},
+      {"connection", entry.connection.toStdString()},
+      {"sql", entry.sql.toStdString()},
+      {"ms", entry.ms},
+      {"rows", entry.rows},
+      {"slow", entry.slow},
+      {"plan", toJson(entry.plan)},
+      {"full_scans", toJson(entry.fullScans)},
+  };
+  auto line = j.dump();
+  line += '\n';
+
+  QMutexLocker lock(&mutex);
+  if (!file.isOpen()) {
+    return;
+  }
+  file.write(line.data(), static_cast<qint64>(line.size()));
+  file.flush();
+  if (file.size() >= config.maxFileBytes) {
+    rotate();
+  }
+}
+
+void QueryLog::rotate() {
+  file.close();
+  QFile::remove(QString("%1.%2").arg(config.path).arg(config.maxFiles));
+  for (int i = config.maxFiles - 1; i >= 1; --i) {
+    QFile::rename(QString("%1.%2").arg(config.path).arg(i),
+                  QString("%1.%2").arg(config.path).arg(i + 1));
+  }
+  if (config.maxFiles > 0) {
+    QFile::rename(config.path, config.path + ".1");
+  } else {
+    QFile::remove(config.path);
+  }
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qWarning().noquote() << "Cannot reopen query log" << config.path << ":"
+                         << file.errorString();
+  }
+}
+
+QString QueryLog::normalizeSql(const QString &sql) {
+  static const QRegularExpression stringLiteral("'(?:[^']|'')*'");
+  static const QRegularExpression numberLiteral(R"(\b\d+(?:\.\d+)?\b)");
+  static const QRegularExpression whitespace(R"(\s+)");
+
+  auto out = sql;
+  out.replace(stringLiteral, "?");
+  out.replace(numberLiteral, "?");
+  out.replace(whitespace, " ");
+  return out.trimmed();
+}
+
+QStringList QueryLog::fullScans(const QStringList &plan) {
+  // "SCAN orders" reads every row; "SCAN orders USING INDEX ..." walks an
+  // index in order, and virtual tables (FTS) plan their own access.
+  QStringList out;
+  for (const auto &step : plan) {
+    if (step.startsWith("SCAN ") && !step.contains("USING ") &&
+        !step.contains("VIRTUAL TABLE")) {
+      out << step;
+    }
+  }
+  return out;
+}
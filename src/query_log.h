@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+struct QueryLogEntry {
+  QString connection;
+  QString sql; // normalized, see QueryLog::normalizeSql()
+  double ms = 0;
+  long long rows = 0; // rows read, or rows changed by a write
+  bool slow = false;
+  QStringList plan;      // EXPLAIN QUERY PLAN details, slow queries only
+  QStringList fullScans; // plan steps that read a whole table
+};
+
+// Process-wide JSON Lines log of query timings, shared by every Database
+// connection. Only queries at or over the slow threshold are written unless
+// logAll is set. The file is rotated once it passes maxFileBytes, keeping
+// up to maxFiles old files as <path>.1, <path>.2, ...
+class QueryLog final {
+public:
+  struct Settings {
+    QString path; // empty disables the log
+    double slowMs = 100;
+    bool logAll = false;
+    qint64 maxFileBytes = 4 << 20;
+    int maxFiles = 3;
+  };
+
+  static QueryLog &instance();
+
+  void configure(const Settings &settings);
+  bool enabled() const;
+  bool isSlow(double ms) const;
+  bool shouldLog(double ms) const;
+  void write(const QueryLogEntry &entry);
+
+  // Collapses whitespace and replaces string and number literals with '?',
+  // so one statement shape logs as one text whatever its arguments.
+  static QString normalizeSql(const QString &sql);
+  // Plan steps that scan a table without an index (e.g. "SCAN orders").
+  static QStringList fullScans(const QStringList &plan);
+
+private:
+  QueryLog() = default;
+
+  mutable QMutex mutex;
+  Settings config;
+  QFile file;
+
+  void rotate();
+};
@@ -0,0 +1,160 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+// Caps memory if recording is left on; later events are dropped.
+constexpr std::size_t kMaxEvents = 2'000'000;
+
+struct TraceEvent {
+  char phase = 'X';
+  const char *name = "";
+  const char *category = "";
+  double ts = 0;
+  double dur = 0;
+  quint64 id = 0;
+  int tid = 0;
+};
+
+struct TraceBuffer {
+  QMutex mutex;
+  std::vector<TraceEvent> events;
+  std::vector<std::pair<int, QString>> threadNames;
+  int nextTid = 1;
+};
+
+TraceBuffer &buffer() {
+  static TraceBuffer b;
+  return b;
+}
+
+const std::chrono::steady_clock::time_point &clockStart() {
+  static const auto start = std::chrono::steady_clock::now();
+  return start;
+}
+
+// Small stable id per thread; the thread's name is captured the first
+// time it records an event (the buffer mutex is held by the caller).
+int currentTid(TraceBuffer &b) {
+  thread_local int tid = 0;
+  if (tid == 0) {
+    tid = b.nextTid++;
+    auto name = QThread::currentThread()->objectName();
+    if (name.isEmpty()) {
+      const auto *app = QCoreApplication::instance();
+      name = app && QThread::currentThread() == app->thread()
+                 ? QStringLiteral("main")
+                 : QString("thread %1").arg(tid);
+    }
+    b.threadNames.emplace_back(tid, name);
+  }
+  return tid;
+}
+
+void record(TraceEvent e) {
+  auto &b = buffer();
+  QMutexLocker lock(&b.mutex);
+  if (b.events.size() >= kMaxEvents) {
+    return;
+  }
+  e.tid = currentTid(b);
+  b.events.push_back(e);
+}
+} // namespace
+
+void Tracer::start() {
+  clockStart();
+  recording.store(true, std::memory_order_relaxed);
+}
+
+bool Tracer::stop(const QString &path, QString &err) {
+  recording.store(false, std::memory_order_relaxed);
+
+  auto &b = buffer();
+  QMutexLocker lock(&b.mutex);
+
+  const auto pid = QCoreApplication::applicationPid();
+  auto events = nlohmann::json::array();
+  for (const auto &[tid, name] : b.threadNames) {
+    events.push_back({{"ph", "M"},
+                      {"name", "thread_name"},
+                      {"pid", pid},
+                      {"tid", tid},
+                      {"args", {{"name", name.toStdString()}}}});
+  }
+  for (const auto &e : b.events) {
+    nlohmann::json j = {{"ph", std::string(1, e.phase)},
+                        {"name", e.name},
+                        {"cat", e.category},
+                        {"ts", e.ts},
+                        {"pid", pid},
+                        {"tid", e.tid}};
+    switch (e.phase) {
+    case 'X':
+      j["dur"] = e.dur;
+      break;
+    case 'b':
+    case 'e':
+      j["id"] = e.id;
+      break;
+    case 'i':
+      j["s"] = "t";
+      break;
+    default:
+      break;
+    }
+    events.push_back(std::move(j));
+  }
+  b.events.clear();
+
+  const nlohmann::json doc = {{"traceEvents", std::move(events)},
+                              {"displayTimeUnit", "ms"}};
+  const auto text = doc.dump();
+
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+      file.write(text.data(), static_cast<qint64>(text.size())) !=
+          static_cast<qint64>(text.size())) {
+    err = file.errorString();
+    return false;
+  }
+  return true;
+}
+
+double Tracer::nowUs() {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - clockStart())
+      .count();
+}
+
+void Tracer::complete(const char *name, const char *category, double startUs,
+                      double durationUs) {
+  record({'X', name, category, startUs, durationUs});
+}
+
+void Tracer::instant(const char *name, const char *category) {
+  if (enabled()) {
+    record({'i', name, category, nowUs()});
+  }
+}
+
+void Tracer::asyncBegin(const char *name, const char *category, quint64 id) {
+  if (enabled()) {
+    record({'b', name, category, nowUs(), 0, id});
+  }
+}
+
+void Tracer::asyncEnd(const char *name, const char *category, quint64 id) {
+  if (enabled()) {
+    record({'e', name, category, nowUs(), 0, id});
+  }
+}
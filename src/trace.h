@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QString>
+#include <atomic>
+
+// In-process recorder for Chrome Trace Event spans (open the output in
+// Perfetto or chrome://tracing). Recording is off unless start() was
+// called; a disabled span costs one relaxed atomic load. Names and
+// categories must be string literals: only the pointers are stored.
+class Tracer final {
+public:
+  static bool enabled() { return recording.load(std::memory_order_relaxed); }
+
+  static void start();
+  // Stops recording and writes everything recorded so far to `path`.
+  static bool stop(const QString &path, QString &err);
+
+  // Microseconds since the process's trace clock started.
+  static double nowUs();
+
+  static void complete(const char *name, const char *category,
+                       double startUs, double durationUs);
+  static void instant(const char *name, const char *category);
+  // Spans that start and end in different calls or threads, matched by
+  // name and id.
+  static void asyncBegin(const char *name, const char *category,
+                         quint64 id);
+  static void asyncEnd(const char *name, const char *category, quint64 id);
+
+private:
+  static inline std::atomic<bool> recording = false;
+};
+
+// Records the enclosing scope as one complete ("X") event.
+class TraceSpan final {
+public:
+  explicit TraceSpan(const char *name, const char *category = "app")
+      : name(name), category(category),
+        startUs(Tracer::enabled() ? Tracer::nowUs() : -1) {}
+  ~TraceSpan() {
+    if (startUs >= 0) {
+      Tracer::complete(name, category, startUs, Tracer::nowUs() - startUs);
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+  const char *name;
+  const char *category;
+  double startUs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(...) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(__VA_ARGS__)
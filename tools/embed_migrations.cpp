@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Build step that turns resources/migrations/NNN_name.sql into a header of
+// constexpr, already-split statements for Database::migrate():
+//
+//   embed_migrations <output.h> <migration.sql>...
+//
+// The version is the file name's numeric prefix. Statements end at ';'
+// outside string literals, except inside a CREATE TRIGGER body, which
+// runs until its closing END.
+//
+// Rebuilding a table drops its indexes and triggers, so the migration
+// has to create them again. Such a re-created index or trigger must match
+// its previous definition word for word; to change one, DROP it
+// explicitly first.
+
+namespace {
+constexpr auto kDelimiter = "sql";
+
+std::string trimmed(const std::string &s) {
+  const auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
+  const auto begin = std::find_if_not(s.begin(), s.end(), isSpace);
+  const auto end = std::find_if_not(s.rbegin(), s.rend(), isSpace).base();
+  return begin < end ? std::string(begin, end) : std::string();
+}
+
+bool isOpenTriggerBody(const std::string &stmt) {
+  static const std::regex createTrigger(
+      R"(^CREATE\s+(TEMP\s+|TEMPORARY\s+)?TRIGGER\b)", std::regex::icase);
+  static const std::regex closingEnd(R"(\bEND$)", std::regex::icase);
+  return std::regex_search(stmt, createTrigger) &&
+         !std::regex_search(stmt, closingEnd);
+}
+
+std::vector<std::string> splitSqlStatements(const std::string &sql) {
+  std::vector<std::string> statements;
+  std::string buffer;
+  bool inSingleQuote = false;
+
+  for (std::size_t i = 0; i < sql.size(); ++i) {
+    const char c = sql[i];
+    if (c == '\'' && (i == 0 || sql[i - 1] != '\\')) {
+      inSingleQuote = !inSingleQuote;
+    }
+
+    if (!inSingleQuote && c == ';') {
+      const auto stmt = trimmed(buffer);
+      if (isOpenTriggerBody(stmt)) {
+        buffer += c;
+        continue;
+      }
+      if (!stmt.empty()) {
+        statements.push_back(stmt);
+      }
+      buffer.clear();
+      continue;
+    }
+    buffer += c;
+  }
+
+  if (auto tail = trimmed(buffer); !tail.empty()) {
+    statements.push_back(std::move(tail));
+  }
+  return statements;
+}
+
+// Name of the index or trigger `stmt` creates (or drops), if it does.
+std::string schemaObject(const std::string &stmt, const std::regex &re) {
+  std::smatch m;
+  return std::regex_search(stmt, m, re) ? m[1].str() : std::string();
+}
+
+int fail(const std::string &message) {
+  std::cerr << "embed_migrations: " << message << '\n';
+  return 1;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    return fail("usage: embed_migrations <output.h> <migration.sql>...");
+  }
+
+  std::map<int, std::vector<std::string>> migrations;
+  for (int i = 2; i < argc; ++i) {
+    const std::filesystem::path path(argv[i]);
+    const auto name = path.filename().string();
+    const auto digits = name.find_first_not_of("0123456789");
+    if (digits == 0 || digits == std::string::npos) {
+      return fail(name + ": name must start with its version number");
+    }
+    const int version = std::stoi(name.substr(0, digits));
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      return fail("cannot read " + path.string());
+    }
+    std::stringstream sql;
+    sql << in.rdbuf();
+
+    auto statements = splitSqlStatements(sql.str());
+    if (statements.empty()) {
+      return fail(name + ": no statements");
+    }
+    for (const auto &stmt : statements) {
+      if (stmt.find(std::string(")") + kDelimiter + "\"") !=
+          std::string::npos) {
+        return fail(name + ": statement contains the raw string delimiter");
+      }
+    }
+    if (!migrations.emplace(version, std::move(statements)).second) {
+      return fail(name + ": duplicate version " + std::to_string(version));
+    }
+  }
+
+  static const std::regex createObject(
+      R"(^CREATE\s+(?:UNIQUE\s+)?(?:INDEX|TRIGGER)\s+)"
+      R"((?:IF\s+NOT\s+EXISTS\s+)?(\w+))",
+      std::regex::icase);
+  static const std::regex dropObject(
+      R"(^DROP\s+(?:INDEX|TRIGGER)\s+(?:IF\s+EXISTS\s+)?(\w+))",
+      std::regex::icase);
+  std::map<std::string, std::pair<int, std::string>> definitions;
+  for (const auto &[version, statements] : migrations) {
+    for (const auto &stmt : statements) {
+      if (const auto name = schemaObject(stmt, dropObject); !name.empty()) {
+        definitions.erase(name);
+        continue;
+      }
+      const auto name = schemaObject(stmt, createObject);
+      if (name.empty()) {
+        continue;
+      }
+      const auto it = definitions.find(name);
+      if (it != definitions.end() && it->second.second != stmt) {
+        return fail(name + " in migration " + std::to_string(version) +
+                    " differs from migration " +
+                    std::to_string(it->second.first) +
+                    "; DROP it first to change it");
+      }
+      definitions[name] = {version, stmt};
+    }
+  }
+
+  std::ostringstream out;
+  out << "// Generated by tools/embed_migrations.cpp; do not edit.\n"
+         "#pragma once\n\n"
+         "#include <array>\n"
+         "#include <span>\n"
+         "#include <string_view>\n\n"
+         "namespace embedded_migrations {\n"
+         "struct Migration {\n"
+         "  int version;\n"
+         "  std::span<const std::string_view> statements;\n"
+         "};\n\n";
+  for (const auto &[version, statements] : migrations) {
+    out << "inline constexpr std::string_view kStatements" << version
+        << "[] = {\n";
+    for (const auto &stmt : statements) {
+      out << "    R\"" << kDelimiter << "(" << stmt << ")" << kDelimiter
+          << "\",\n";
+    }
+    out << "};\n\n";
+  }
+  out << "inline constexpr std::array<Migration, " << migrations.size()
+      << "> kMigrations = {{\n";
+  for (const auto &[version, statements] : migrations) {
+    out << "    {" << version << ", kStatements" << version << "},\n";
+  }
+  out << "}};\n\n"
+         "inline constexpr int kLatestVersion = "
+      << migrations.rbegin()->first << ";\n"
+      << "} // namespace embedded_migrations\n";
+
+  const std::filesystem::path output(argv[1]);
+  if (output.has_parent_path()) {
+    std::filesystem::create_directories(output.parent_path());
+  }
+  std::ofstream file(output, std::ios::binary | std::ios::trunc);
+  file << out.str();
+  if (!file) {
+    return fail("cannot write " + output.string());
+  }
+  return 0;
+}
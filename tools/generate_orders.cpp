@@ -0,0 +1,387 @@
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDate>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "database.h"
+#include "models.h"
+
+// Fills an orders database with synthetic rows for load testing:
+//
+//   generate_orders --rows 10000000 --seed 7 --output orders.sqlite
+//
+// Rows are produced in fixed-size chunks, each from its own RNG seeded by
+// (seed, chunk index), so the output depends on the seed only, not on the
+// number of threads. Producers run one per core; the main thread writes
+// finished chunks in order through Database::insertOrders.
+
+namespace {
+constexpr long long kChunkRows = 50'000;
+
+const std::array<const char *, 24> kFirstNames = {
+    "Ava",   "Ben",    "Chloe", "Daniel", "Ella",   "Felix",
+    "Grace", "Hugo",   "Isla",  "Jack",   "Keira",  "Liam",
+    "Maya",  "Noah",   "Olive", "Paul",   "Quinn",  "Ruby",
+    "Sam",   "Tara",   "Umar",  "Vera",   "Will",   "Zoe",
+};
+const std::array<const char *, 24> kLastNames = {
+    "Adams",  "Baker",  "Clark",  "Davis",  "Evans",  "Fisher",
+    "Garcia", "Hughes", "Irwin",  "Jones",  "King",   "Lopez",
+    "Miller", "Nolan",  "Owens",  "Patel",  "Reid",   "Smith",
+    "Turner", "Usman",  "Vance",  "Walker", "Young",  "Zhang",
+};
+const std::array<const char *, 12> kProductKinds = {
+    "Pallet", "Crate",  "Container", "Drum",  "Bundle", "Parcel",
+    "Tube",   "Carton", "Sack",      "Reel",  "Tank",   "Case",
+};
+const std::array<const char *, 8> kProductGrades = {
+    "Standard", "Heavy", "Light", "Cold", "Fragile", "Bulk", "Express",
+    "Oversize",
+};
+
+// Samples ranks 0..n-1 with P(k) proportional to 1 / (k + 1)^s.
+class ZipfSampler final {
+public:
+  ZipfSampler(int n, double s) : cdf(static_cast<std::size_t>(n)) {
+    double sum = 0;
+    for (int k = 0; k < n; ++k) {
+      sum += 1.0 / std::pow(k + 1, s);
+      cdf[static_cast<std::size_t>(k)] = sum;
+    }
+    for (auto &c : cdf) {
+      c /= sum;
+    }
+  }
+
+  template <typename Rng> int operator()(Rng &rng) const {
+    const double u = std::uniform_real_distribution<double>(0, 1)(rng);
+    const auto it = std::lower_bound(cdf.begin(), cdf.end(), u);
+    return static_cast<int>(std::min<std::ptrdiff_t>(
+        it - cdf.begin(), static_cast<std::ptrdiff_t>(cdf.size()) - 1));
+  }
+
+private:
+  std::vector<double> cdf;
+};
+
+struct GeneratorConfig {
+  long long rows = 1'000'000;
+  quint64 seed = 1;
+  int customers = 200'000;
+  int products = 5'000;
+  double zipfExponent = 1.1;
+  std::vector<double> statusWeights; // parallel to orderStatuses()
+  QDate from;
+  QDate to;
+  int threads = 1;
+};
+
+// Shared, read-only inputs for the producers. Names are built once so a
+// sampled rank is just a copy of an implicitly shared QString.
+class OrderFactory final {
+public:
+  explicit OrderFactory(const GeneratorConfig &config)
+      : config(config), customerRank(config.customers, config.zipfExponent),
+        productRank(config.products, config.zipfExponent) {
+    customerNames.reserve(static_cast<std::size_t>(config.customers));
+    for (int i = 0; i < config.customers; ++i) {
+      const auto first = QString::fromLatin1(
+          kFirstNames[static_cast<std::size_t>(i) % kFirstNames.size()]);
+      const auto last = QString::fromLatin1(
+          kLastNames[static_cast<std::size_t>(i) / kFirstNames.size() %
+                     kLastNames.size()]);
+      const int block = i / static_cast<int>(kFirstNames.size() *
+                                             kLastNames.size());
+      customerNames.push_back(
+          block == 0 ? QString("%1 %2").arg(first, last)
+                     : QString("%1 %2 %3").arg(first, last).arg(block + 1));
+    }
+
+    productNames.reserve(static_cast<std::size_t>(config.products));
+    for (int i = 0; i < config.products; ++i) {
+      const auto kind = QString::fromLatin1(
+          kProductKinds[static_cast<std::size_t>(i) % kProductKinds.size()]);
+      const auto grade = QString::fromLatin1(
+          kProductGrades[static_cast<std::size_t>(i) / kProductKinds.size() %
+                         kProductGrades.size()]);
+      productNames.push_back(QString("%1 %2 #%3").arg(grade, kind).arg(i + 1));
+    }
+  }
+
+  std::vector<OrderDraft> chunk(long long index, long long rows) const {
+    // Mixing the chunk index into the seed keeps chunks independent of
+    // each other and of which thread produced them.
+    std::seed_seq seq{static_cast<quint32>(config.seed),
+                      static_cast<quint32>(config.seed >> 32),
+                      static_cast<quint32>(index),
+                      static_cast<quint32>(index >> 32)};
+    std::mt19937_64 rng(seq);
+
+    std::discrete_distribution<int> status(config.statusWeights.begin(),
+                                           config.statusWeights.end());
+    std::uniform_int_distribution<qint64> day(config.from.toJulianDay(),
+                                              config.to.toJulianDay());
+    std::geometric_distribution<int> extraQuantity(0.2);
+
+    std::vector<OrderDraft> out(static_cast<std::size_t>(rows));
+    for (auto &o : out) {
+      o.customer = customerNames[static_cast<std::size_t>(customerRank(rng))];
+      o.product = productNames[static_cast<std::size_t>(productRank(rng))];
+      o.quantity = 1 + std::min(extraQuantity(rng), 499);
+      o.status = static_cast<OrderStatus>(status(rng));
+      o.orderDate = QDate::fromJulianDay(day(rng));
+    }
+    return out;
+  }
+
+private:
+  const GeneratorConfig &config;
+  ZipfSampler customerRank;
+  ZipfSampler productRank;
+  std::vector<QString> customerNames;
+  std::vector<QString> productNames;
+};
+
+// Chunks finished by the producers, handed to the writer in index order.
+// Producers stall once they are `window` chunks ahead of the writer, which
+// bounds memory.
+class ChunkQueue final {
+public:
+  explicit ChunkQueue(long long window) : window(window) {}
+
+  // Blocks until chunk `index` may be produced; false once stopped.
+  bool waitForSlot(long long index) {
+    std::unique_lock lock(mutex);
+    slotFree.wait(lock, [&] { return stopped || index < nextWrite + window; });
+    return !stopped;
+  }
+
+  void put(long long index, std::vector<OrderDraft> rows) {
+    {
+      std::lock_guard lock(mutex);
+      ready.emplace(index, std::move(rows));
+    }
+    chunkReady.notify_one();
+  }
+
+  // Next chunk in order; nullopt once stopped.
+  std::optional<std::vector<OrderDraft>> take() {
+    std::unique_lock lock(mutex);
+    chunkReady.wait(lock, [&] { return stopped || ready.contains(nextWrite); });
+    if (stopped) {
+      return std::nullopt;
+    }
+    auto node = ready.extract(nextWrite);
+    ++nextWrite;
+    lock.unlock();
+    slotFree.notify_all();
+    return std::move(node.mapped());
+  }
+
+  void stop() {
+    {
+      std::lock_guard lock(mutex);
+      stopped = true;
+    }
+    slotFree.notify_all();
+    chunkReady.notify_all();
+  }
+
+private:
+  const long long window;
+  std::mutex mutex;
+  std::condition_variable slotFree;
+  std::condition_variable chunkReady;
+  std::map<long long, std::vector<OrderDraft>> ready;
+  long long nextWrite = 0;
+  bool stopped = false;
+};
+
+// "pending=50,shipped=30,..." -> weights in orderStatuses() order.
+std::optional<std::vector<double>> parseStatusMix(const QString &text,
+                                                  QString &err) {
+  std::vector<double> weights(static_cast<std::size_t>(orderStatuses().size()),
+                              0.0);
+  for (const auto &entry : text.split(',', Qt::SkipEmptyParts)) {
+    const auto parts = entry.split('=');
+    const auto index = orderStatuses().indexOf(parts.value(0).trimmed());
+    bool ok = false;
+    const double weight = parts.value(1).toDouble(&ok);
+    if (parts.size() != 2 || index < 0 || !ok || weight < 0) {
+      err = QString("invalid status weight '%1'").arg(entry);
+      return std::nullopt;
+    }
+    weights[static_cast<std::size_t>(index)] = weight;
+  }
+  if (std::all_of(weights.begin(), weights.end(),
+                  [](double w) { return w == 0; })) {
+    err = "status mix has no positive weight";
+    return std::nullopt;
+  }
+  return weights;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("generate_orders");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Fills an orders database with synthetic, reproducible data.");
+  parser.addHelpOption();
+  const QCommandLineOption outputOption(
+      {"o", "output"}, "SQLite file to create or extend.", "path");
+  const QCommandLineOption rowsOption("rows", "Number of orders to add.",
+                                      "count", "1000000");
+  const QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+  const QCommandLineOption customersOption(
+      "customers", "Number of distinct customers.", "count", "200000");
+  const QCommandLineOption productsOption(
+      "products", "Number of distinct products.", "count", "5000");
+  const QCommandLineOption zipfOption(
+      "zipf", "Zipf exponent for customer and product frequency.", "s",
+      "1.1");
+  const QCommandLineOption statusOption(
+      "status-mix", "Relative status weights, e.g. pending=1,shipped=4.",
+      "weights",
+      "pending=10,processing=10,shipped=20,delivered=55,cancelled=5");
+  const QCommandLineOption fromOption("from", "First order date.", "date",
+                                      "2020-01-01");
+  const QCommandLineOption toOption("to", "Last order date.", "date",
+                                    QDate::currentDate().toString(Qt::ISODate));
+  const QCommandLineOption threadsOption(
+      "threads", "Producer threads (default: one per core).", "count");
+  parser.addOptions({outputOption, rowsOption, seedOption, customersOption,
+                     productsOption, zipfOption, statusOption, fromOption,
+                     toOption, threadsOption});
+  parser.process(app);
+
+  auto fail = [](const QString &msg) {
+    qCritical().noquote() << msg;
+    return 1;
+  };
+
+  if (!parser.isSet(outputOption)) {
+    return fail("--output is required");
+  }
+
+  GeneratorConfig config;
+  bool ok = true;
+  auto number = [&](const QCommandLineOption &option) {
+    bool parsed = false;
+    const auto value = parser.value(option).toLongLong(&parsed);
+    ok = ok && parsed && value > 0;
+    return value;
+  };
+  config.rows = number(rowsOption);
+  config.customers = static_cast<int>(number(customersOption));
+  config.products = static_cast<int>(number(productsOption));
+  bool seedOk = false;
+  config.seed = parser.value(seedOption).toULongLong(&seedOk);
+  ok = ok && seedOk;
+  config.zipfExponent = parser.value(zipfOption).toDouble();
+  config.from = QDate::fromString(parser.value(fromOption), Qt::ISODate);
+  config.to = QDate::fromString(parser.value(toOption), Qt::ISODate);
+  config.threads =
+      parser.isSet(threadsOption)
+          ? static_cast<int>(number(threadsOption))
+          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  if (!ok || config.zipfExponent <= 0) {
+    return fail("counts, seed and --zipf must be positive numbers");
+  }
+  if (!config.from.isValid() || !config.to.isValid() ||
+      config.from > config.to) {
+    return fail("--from and --to must be ISO dates with from <= to");
+  }
+  QString err;
+  auto weights = parseStatusMix(parser.value(statusOption), err);
+  if (!weights) {
+    return fail(err);
+  }
+  config.statusWeights = std::move(*weights);
+
+  Database db("generate_orders", parser.value(outputOption));
+  if (!db.open(ConnectionProfile::BulkIngest) || !db.migrate()) {
+    return fail(db.lastError());
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  const OrderFactory factory(config);
+  const long long chunks = (config.rows + kChunkRows - 1) / kChunkRows;
+  ChunkQueue queue(2LL * config.threads);
+  std::atomic<long long> nextChunk = 0;
+
+  std::vector<std::jthread> producers;
+  for (int t = 0; t < config.threads; ++t) {
+    producers.emplace_back([&] {
+      for (long long i = nextChunk++; i < chunks; i = nextChunk++) {
+        if (!queue.waitForSlot(i)) {
+          return;
+        }
+        const auto rows = std::min(kChunkRows, config.rows - i * kChunkRows);
+        queue.put(i, factory.chunk(i, rows));
+      }
+    });
+  }
+
+  long long written = 0;
+  bool writeFailed = false;
+  for (long long i = 0; i < chunks; ++i) {
+    auto rows = queue.take();
+    if (!rows || !db.insertOrders(*rows)) {
+      writeFailed = true;
+      break;
+    }
+    written += static_cast<long long>(rows->size());
+    if ((i + 1) % 20 == 0 || i + 1 == chunks) {
+      qInfo().noquote() << QString("%1 / %2 orders").arg(written).arg(
+          config.rows);
+    }
+  }
+  queue.stop();
+  producers.clear();
+
+  if (writeFailed) {
+    return fail(db.lastError());
+  }
+
+  // No app has seen these orders yet, so their changelog entries are of
+  // no use; left in, the app's first prune would have to work through
+  // millions of them.
+  for (;;) {
+    const auto pruned = db.pruneChangelog(0, kChunkRows);
+    if (!pruned) {
+      return fail(db.lastError());
+    }
+    if (*pruned < kChunkRows) {
+      break;
+    }
+  }
+
+  const double seconds = static_cast<double>(timer.elapsed()) / 1000.0;
+  qInfo().noquote() << QString("Wrote %1 orders in %2 s (%3 rows/s)")
+                           .arg(written)
+                           .arg(seconds, 0, 'f', 1)
+                           .arg(seconds > 0 ? written / seconds : 0.0, 0, 'f',
+                                0);
+  db.close();
+  return 0;
+}